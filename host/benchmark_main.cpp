@@ -0,0 +1,13 @@
+// Runs the benchmark suite on the host and prints its JSON, so that revisions
+// can be compared without flashing a device:
+//   ./benchmark > before.json
+
+#include "benchmark.h"
+#include "host_print.h"
+
+int main() {
+    FilePrint output(stdout);
+    runBenchmarks(output);
+    output.println();
+    return 0;
+}
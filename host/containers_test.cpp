@@ -0,0 +1,304 @@
+// The fixed capacity containers: StaticVector and RingBuffer copies, moves and
+// wraparound, SmallMap removal within clusters that wrap past slot 0, checked
+// against std::map, and the links of IntrusiveList.
+
+#include <map>
+#include <stdint.h>
+#include <stdlib.h>
+#include "intrusive_list.h"
+#include "ring_buffer.h"
+#include "small_map.h"
+#include "static_vector.h"
+#include "test.h"
+
+// Counts the live instances, so that every element constructed is destroyed
+// exactly once, and marks what has been moved from.
+class Tracked {
+public:
+    static int liveCount;
+
+    Tracked(int value = 0): _value(value) { ++liveCount; }
+    Tracked(const Tracked& other): _value(other._value) { ++liveCount; }
+    Tracked(Tracked&& other): _value(other._value) {
+        other._value = kMovedFrom;
+        ++liveCount;
+    }
+    ~Tracked() { --liveCount; }
+
+    Tracked& operator=(const Tracked& other) {
+        _value = other._value;
+        return *this;
+    }
+
+    Tracked& operator=(Tracked&& other) {
+        _value = other._value;
+        other._value = kMovedFrom;
+        return *this;
+    }
+
+    int value() const { return _value; }
+
+private:
+    static const int kMovedFrom = -1;
+
+    int _value;
+};
+
+int Tracked::liveCount;
+
+static void testStaticVector() {
+    {
+        StaticVector<Tracked, 4> vector;
+        for (int i = 0; i < 4; ++i) {
+            CHECK(vector.append(Tracked(i)));
+        }
+        CHECK(vector.isFull());
+        CHECK(!vector.append(Tracked(4)));
+        CHECK(Tracked::liveCount == 4);
+
+        vector.remove(1);
+        CHECK(vector.size() == 3 && vector[0].value() == 0 && vector[1].value() == 2 && vector[2].value() == 3);
+
+        StaticVector<Tracked, 4> copy(vector);
+        CHECK(copy.size() == 3 && copy[2].value() == 3 && vector[2].value() == 3);
+
+        StaticVector<Tracked, 4> moved(std::move(vector));
+        CHECK(moved.size() == 3 && moved[0].value() == 0 && moved[2].value() == 3);
+        CHECK(vector.isEmpty());
+
+        vector = copy;
+        CHECK(vector.size() == 3 && vector[1].value() == 2);
+        copy.removeLast();
+        vector = std::move(copy);
+        CHECK(vector.size() == 2 && vector[1].value() == 2 && copy.isEmpty());
+        CHECK(Tracked::liveCount == 5);
+    }
+    CHECK(Tracked::liveCount == 0);
+}
+
+static void testRingBuffer() {
+    {
+        RingBuffer<Tracked, 4> buffer;
+
+        // move the head around the end of the storage several times
+        int next = 0;
+        int expected = 0;
+        for (int round = 0; round < 10; ++round) {
+            while (buffer.push(Tracked(next))) {
+                ++next;
+            }
+            CHECK(buffer.isFull() && buffer.size() == 4);
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                CHECK_THAT(buffer[i].value() == expected + int(i), "round %d: [%zu] is %d", round, i,
+                           buffer[i].value());
+            }
+
+            int popCount = 1 + round % 3;
+            for (int i = 0; i < popCount; ++i) {
+                CHECK(buffer.front().value() == expected++);
+                buffer.pop();
+            }
+        }
+        CHECK(Tracked::liveCount == int(buffer.size()));
+
+        // copies and moves keep the order, counted from the oldest element
+        RingBuffer<Tracked, 4> copy(buffer);
+        CHECK(copy.size() == buffer.size());
+        for (size_t i = 0; i < copy.size(); ++i) {
+            CHECK(copy[i].value() == buffer[i].value());
+        }
+
+        int front = buffer.front().value();
+        size_t size = buffer.size();
+        RingBuffer<Tracked, 4> moved(std::move(buffer));
+        CHECK(buffer.isEmpty() && moved.size() == size && moved.front().value() == front);
+
+        // a moved-into buffer starts over at slot 0 and still fills up
+        CHECK(moved.push(Tracked(100)));
+        copy = moved;
+        CHECK(copy.size() == size + 1 && copy[size].value() == 100);
+        buffer = std::move(copy);
+        CHECK(copy.isEmpty() && buffer.size() == size + 1 && buffer.front().value() == front);
+        while (buffer.push(Tracked(101))) {
+        }
+        CHECK(buffer.size() == 4);
+    }
+    CHECK(Tracked::liveCount == 0);
+}
+
+// the probe start of a key is the key itself, so collisions can be arranged
+struct IdentityHash {
+    uint32_t operator()(uint32_t key) const { return key; }
+};
+
+typedef SmallMap<uint32_t, Tracked, 8, IdentityHash> CollidingMap;
+
+static bool containsExactly(const CollidingMap& map, const std::map<uint32_t, int>& expected) {
+    if (map.size() != expected.size()) {
+        return false;
+    }
+    for (const auto& entry : expected) {
+        const Tracked* value = map.find(entry.first);
+        if (!value || value->value() != entry.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testSmallMapWrappedCluster() {
+    {
+        CollidingMap map;
+        CHECK(map.capacity() == 7);
+
+        // 6, 14 and 22 start at slot 6, 7 and 15 at slot 7, 8 at slot 0: the
+        // cluster runs 6 7 0 1 2 3 and wraps past slot 0
+        std::map<uint32_t, int> expected;
+        static const uint32_t kKeys[] = {6, 14, 7, 22, 15, 8};
+        for (uint32_t key : kKeys) {
+            CHECK(map.put(key, Tracked(key * 10)));
+            expected[key] = key * 10;
+        }
+        CHECK(containsExactly(map, expected));
+        CHECK(!map.find(30) && !map.find(0));
+
+        // replacing keeps the size
+        CHECK(map.put(22, Tracked(1)));
+        expected[22] = 1;
+        CHECK(containsExactly(map, expected));
+
+        // the head of the cluster: everything behind it has to shift back over slot 0
+        CHECK(map.remove(6));
+        expected.erase(6);
+        CHECK(containsExactly(map, expected));
+        CHECK(!map.remove(6));
+
+        // an entry in its own start slot, right after the wrap
+        CHECK(map.remove(8));
+        expected.erase(8);
+        CHECK(containsExactly(map, expected));
+
+        CHECK(map.put(6, Tracked(60)) && map.put(0, Tracked(0)) && map.put(1, Tracked(10)));
+        expected[6] = 60;
+        expected[0] = 0;
+        expected[1] = 10;
+        CHECK(map.isFull() && !map.put(2, Tracked(20)));
+        CHECK(containsExactly(map, expected));
+
+        CollidingMap copy(map);
+        CHECK(containsExactly(copy, expected) && containsExactly(map, expected));
+        CollidingMap moved(std::move(map));
+        CHECK(containsExactly(moved, expected) && map.isEmpty());
+        map = moved;
+        CHECK(containsExactly(map, expected));
+        copy.clear();
+        copy = std::move(moved);
+        CHECK(containsExactly(copy, expected) && moved.isEmpty());
+        CHECK(Tracked::liveCount == int(2 * expected.size()));
+    }
+    CHECK(Tracked::liveCount == 0);
+}
+
+static void testSmallMapAgainstMap() {
+    // random puts and removals on a few keys crowded into 8 slots, so that
+    // clusters form, wrap and collide, checked against std::map after each one
+    {
+        CollidingMap map;
+        std::map<uint32_t, int> expected;
+        srand(1);
+        for (int i = 0; i < 100000; ++i) {
+            uint32_t key = rand() % 24;
+            if (rand() % 2) {
+                bool isPut = map.put(key, Tracked(i));
+                CHECK_THAT(isPut == (expected.count(key) || expected.size() < map.capacity()),
+                           "step %d: put %u", i, key);
+                if (isPut) {
+                    expected[key] = i;
+                }
+            }
+            else {
+                CHECK_THAT(map.remove(key) == (expected.erase(key) == 1), "step %d: remove %u", i, key);
+            }
+            CHECK_THAT(containsExactly(map, expected), "step %d: lost track after key %u", i, key);
+            if (testFailureCount > 0) {
+                break;
+            }
+        }
+    }
+    CHECK(Tracked::liveCount == 0);
+}
+
+static void testSmallMapStrings() {
+    SmallMap<const char*, int, 4> map;
+    char key[] = "valve";
+    CHECK(map.put("valve", 1) && map.put("flow", 2));
+    CHECK(map.find(key) && *map.find(key) == 1);
+    CHECK(map.remove(key) && !map.find("valve") && *map.find("flow") == 2);
+}
+
+struct Item: public IntrusiveListNode {
+    Item(int value): value(value) {}
+    int value;
+};
+
+static bool listIs(const IntrusiveList<Item>& list, std::initializer_list<int> values) {
+    if (list.size() != values.size()) {
+        return false;
+    }
+    const int* expected = values.begin();
+    for (const Item& item : list) {
+        if (item.value != *expected++) {
+            return false;
+        }
+    }
+    return values.size() == 0 ? !list.first() && !list.last() : list.last()->value == *(values.end() - 1);
+}
+
+static void testIntrusiveList() {
+    Item a(1), b(2), c(3), d(4);
+    IntrusiveList<Item> list;
+
+    CHECK(list.append(b) && list.append(c) && list.prepend(a));
+    CHECK(listIs(list, {1, 2, 3}));
+    CHECK(a.isLinked() && !d.isLinked());
+    CHECK(!list.append(a));
+
+    // the middle, the last and the first element
+    list.remove(b);
+    CHECK(!b.isLinked() && listIs(list, {1, 3}));
+    CHECK(list.append(d) && list.append(b));
+    CHECK(listIs(list, {1, 3, 4, 2}));
+    list.remove(b);
+    CHECK(listIs(list, {1, 3, 4}) && list.last() == &d);
+    CHECK(list.removeFirst() == &a && !a.isLinked());
+    CHECK(listIs(list, {3, 4}) && list.first() == &c);
+
+    // a copy of an element is not in the list
+    Item copy(c);
+    CHECK(!copy.isLinked() && list.append(copy));
+    CHECK(listIs(list, {3, 4, 3}));
+
+    IntrusiveList<Item> moved(std::move(list));
+    CHECK(listIs(list, {}) && listIs(moved, {3, 4, 3}));
+    CHECK(list.append(a) && listIs(list, {1}));
+
+    // assignment unlinks what the target held
+    list = std::move(moved);
+    CHECK(!a.isLinked() && listIs(list, {3, 4, 3}) && listIs(moved, {}));
+    list.remove(d);
+    CHECK(listIs(list, {3, 3}));
+
+    list.clear();
+    CHECK(listIs(list, {}) && !c.isLinked() && !copy.isLinked());
+    CHECK(list.removeFirst() == nullptr);
+}
+
+int main() {
+    testStaticVector();
+    testRingBuffer();
+    testSmallMapWrappedCluster();
+    testSmallMapAgainstMap();
+    testSmallMapStrings();
+    testIntrusiveList();
+    return testResult("containers");
+}
@@ -0,0 +1,163 @@
+// Host stand-ins for the firmware subsystems the web service reports on and
+// hands work to. They keep what the handlers give them, so that requests can
+// be replayed and their effect checked, but drive no hardware. A valve task
+// runs by time alone, for as long as it asks.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "duty_cycle_manager.h"
+#include "flow_meter.h"
+#include "irrigator.h"
+#include "persistence.h"
+#include "power_manager.h"
+#include "scheduler.h"
+#include "string_ext.h"
+#include "syslog.h"
+
+EEPROMClass EEPROM;
+
+DutyCycleManagerClass DutyCycleManager;
+FlowMeterClass FlowMeter;
+IrrigatorClass Irrigator;
+PersistenceClass Persistence;
+PowerManagerClass PowerManager;
+SchedulerClass Scheduler;
+SyslogClass Syslog;
+
+// the cycle is reported as having run this long ago
+static constexpr TimeInterval kHostTimeSinceLastCycle = 6_h;
+
+DutyCycleManagerClass::DutyCycleManagerClass():
+    _lastCycleCumulativeTime(CumulativeTime::distantPast()),
+    _lastCycleUnixTime(UnixTime::distantPast()),
+    _isScheduled(false),
+    _scheduledCumulativeTime(CumulativeTime::distantPast()),
+    _cycleInterval(24_h),
+    _generation(1) {
+    for (int i = 0; i < kNumOutputValves; ++i) {
+        _tasks[i] = {};
+        _tasks[i].valve = outputValves[i];
+        _tasks[i].isEnabled = i % 2 == 0;
+        _tasks[i].duration = 600;
+        snprintf(_tasks[i].description, sizeof(_tasks[i].description), "Bed %d", i + 1);
+    }
+}
+
+void DutyCycleManagerClass::updateTask(const Task& task) {
+    _tasks[task.valve] = task;
+    ++_generation;
+}
+
+TimeInterval DutyCycleManagerClass::timeIntervalSinceLastCycle() const {
+    return kHostTimeSinceLastCycle;
+}
+
+TimeInterval DutyCycleManagerClass::timeIntervalTillNextCycle() const {
+    return _cycleInterval - kHostTimeSinceLastCycle;
+}
+
+void DutyCycleManagerClass::reset() {
+    _isScheduled = false;
+    ++_generation;
+}
+
+void DutyCycleManagerClass::schedule(const TimeInterval& ti) {
+    _isScheduled = true;
+    ++_generation;
+}
+
+void DutyCycleManagerClass::setCycleInterval(const TimeInterval& ti) {
+    if (ti.seconds() < 60) {
+        return;
+    }
+
+    _cycleInterval = ti;
+    ++_generation;
+}
+
+FlowMeterClass::FlowMeterClass(): _pulsesPerLitre(0), _pulseCount(0) {
+    for (int i = 0; i < kNumOutputValves; ++i) {
+        _totalMillilitres[i] = 0;
+    }
+}
+
+IrrigatorClass::IrrigatorClass():
+    _openValvesMask(0),
+    _outputValvesMask(0),
+    _switchingValvesMask(0),
+    _pendingCloseMask(0),
+    _hasActiveTask(false),
+    _taskStartMillis(0),
+    _flowCounter(1) {
+}
+
+void IrrigatorClass::beginTask(const Task& task) {
+    _activeTask = task;
+    _hasActiveTask = true;
+    _taskStartMillis = millis();
+    _openValvesMask = 1 << task.valve;
+}
+
+bool IrrigatorClass::updateTask() {
+    return activeTaskElapsedMillis() >= uint32_t(_activeTask.duration) * 1000;
+}
+
+void IrrigatorClass::endTask() {
+    _hasActiveTask = false;
+    _openValvesMask = 0;
+}
+
+uint32_t IrrigatorClass::activeTaskElapsedMillis() const {
+    return _hasActiveTask ? millis() - _taskStartMillis : 0;
+}
+
+uint32_t IrrigatorClass::activeTaskMillilitres() const {
+    return 0;
+}
+
+void IrrigatorClass::update() {}
+
+TimeInterval IrrigatorClass::timeIntervalTillUpdate() const {
+    return TimeInterval::withMilliseconds(kTaskPollInterval);
+}
+
+PersistenceClass::PersistenceClass():
+    _commitDeadline(DeviceTime::distantPast()),
+    _commitCount(0),
+    _failedCommitCount(0),
+    _lastCommitLatencyMicros(0),
+    _maxCommitLatencyMicros(0) {
+    for (int i = 0; i < kNumSubsystems; ++i) {
+        _dirtyRanges[i].first = -1;
+        _dirtyRanges[i].last = -1;
+    }
+}
+
+static constexpr char kModeNames[] PROGMEM = "modem\0" "light\0" "deep";
+
+PowerManagerClass::PowerManagerClass(): _isDeepSleepAllowed(false), _mode(kPowerModeModemSleep) {
+    for (int i = 0; i < kNumPowerModes; ++i) {
+        _millisInMode[i] = 0;
+    }
+}
+
+const __FlashStringHelper* PowerManagerClass::modeName(PowerMode mode) {
+    return flashStringAt(kModeNames, mode);
+}
+
+SchedulerClass::SchedulerClass():
+    _sourceCount(0),
+    _conditionCount(0),
+    _lastSleepMillis(0),
+    _totalSleepMillis(0),
+    _lastWakeReason(F("")) {
+}
+
+SyslogClass::SyslogClass():
+    _port(kDefaultPort),
+    _isEnabled(false),
+    _cursor(0),
+    _lastFlushTime(0),
+    _sentCount(0),
+    _lostCount(0) {
+}
@@ -0,0 +1,87 @@
+// FlowCounter: volume targets compared in pulses, stall detection and the
+// wraparound of both the pulse counter and millis().
+
+#include <stdint.h>
+#include "flow_counter.h"
+#include "test.h"
+
+static const uint16_t kPulsesPerLitre = 450;
+
+static void testHasReached() {
+    FlowCounter counter(kPulsesPerLitre);
+    counter.reset(0, 0);
+
+    CHECK(counter.hasReached(0));
+    CHECK(!counter.hasReached(1));
+
+    // a litre is exactly 450 pulses
+    counter.update(449, 0);
+    CHECK(!counter.hasReached(1000));
+    counter.update(450, 0);
+    CHECK(counter.hasReached(1000));
+    CHECK(counter.millilitres() == 1000);
+
+    // a pulse is 2.2ml: the target is rounded up to whole pulses, the volume down
+    counter.update(1, 0);
+    CHECK(counter.millilitres() == 2);
+    CHECK(counter.hasReached(2));
+    CHECK(!counter.hasReached(3));
+
+    // so a target is reached exactly when the volume reported reaches it
+    for (uint32_t pulses = 0; pulses <= 2 * kPulsesPerLitre; ++pulses) {
+        counter.update(pulses, 0);
+        for (uint32_t target = 0; target <= 2100; ++target) {
+            CHECK_THAT(counter.hasReached(target) == (counter.millilitres() >= target),
+                       "%u pulses against %uml", pulses, target);
+        }
+    }
+
+    // no overflow at the ends of the ranges
+    counter.update(UINT32_MAX, 0);
+    CHECK(counter.millilitres() == uint32_t(uint64_t(UINT32_MAX) * 1000 / kPulsesPerLitre));
+    CHECK(counter.hasReached(UINT32_MAX));
+    counter.update(0, 0);
+    CHECK(!counter.hasReached(UINT32_MAX));
+}
+
+static void testWraparound() {
+    FlowCounter counter(kPulsesPerLitre);
+
+    // the free running counter of the ISR wraps around during the measurement
+    counter.reset(UINT32_MAX - 99, 0);
+    counter.update(UINT32_MAX, 0);
+    CHECK(counter.pulses() == 99);
+    counter.update(350, 0);
+    CHECK(counter.pulses() == 450);
+    CHECK(counter.hasReached(1000));
+}
+
+static void testIsStalled() {
+    static const uint32_t kTimeout = 10000;
+
+    FlowCounter counter(kPulsesPerLitre);
+    counter.reset(1000, 5000);
+
+    // the timeout runs from the start until the first pulse
+    CHECK(!counter.isStalled(5000, kTimeout));
+    CHECK(!counter.isStalled(14999, kTimeout));
+    CHECK(counter.isStalled(15000, kTimeout));
+
+    // a pulse restarts it, an update without one does not
+    counter.update(1001, 12000);
+    CHECK(!counter.isStalled(21999, kTimeout));
+    counter.update(1001, 20000);
+    CHECK(counter.isStalled(22000, kTimeout));
+
+    // and millis() may wrap around in between
+    counter.reset(0, UINT32_MAX - 999);
+    CHECK(!counter.isStalled(8999, kTimeout));
+    CHECK(counter.isStalled(9000, kTimeout));
+}
+
+int main() {
+    testHasReached();
+    testWraparound();
+    testIsStalled();
+    return testResult("flow_counter");
+}
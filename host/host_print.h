@@ -0,0 +1,26 @@
+#ifndef __host_print_h
+#define __host_print_h
+
+#include <Print.h>
+#include <stdio.h>
+
+// Prints to a stdio stream, for the host tools to show what the firmware renders.
+class FilePrint: public Print {
+public:
+    FilePrint(FILE* file): _file(file) {}
+
+    using Print::write;
+
+    size_t write(uint8_t ch) override {
+        return fputc(ch, _file) == EOF ? 0 : 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return fwrite(buffer, 1, size, _file);
+    }
+
+private:
+    FILE* _file;
+};
+
+#endif // __host_print_h
@@ -0,0 +1,54 @@
+// Runs the load generator of benchmark.cpp on the host and prints its JSON:
+//   ./load [requests] [--valve-active]
+// With --valve-active a manual valve command from the ValveQueue runs meanwhile.
+// That is the only valve task that can be active while the device serves: a
+// duty cycle blocks the loop until it is done, so no request is served during one.
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "host_print.h"
+#include "http_request.h"
+#include "irrigator.h"
+#include "request_stream.h"
+#include "valve_queue.h"
+
+// with the credentials the web service is built with, "*:*"
+static const char kOriginRequest[] =
+    "GET /debug/load/ HTTP/1.1\r\n"
+    "Host: irrigator.local\r\n"
+    "Authorization: Basic Kjoq\r\n"
+    "\r\n";
+
+int main(int argc, char** argv) {
+    int requestCount = kMaxLoadRequests;
+    bool isValveActive = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--valve-active") == 0) {
+            isValveActive = true;
+        }
+        else {
+            requestCount = atoi(argv[i]);
+        }
+    }
+    if (requestCount <= 0) {
+        fprintf(stderr, "usage: %s [requests] [--valve-active]\n", argv[0]);
+        return 1;
+    }
+
+    if (isValveActive) {
+        IrrigatorClass::Task task = {};
+        task.valve = kValveOutput1;
+        task.duration = 3600;
+        ValveQueue.post(task);
+        ValveQueue.run();
+    }
+
+    RequestStream stream(kOriginRequest);
+    HTTPRequest origin(stream);
+
+    FilePrint output(stdout);
+    runLoad(origin, requestCount, output);
+    output.println();
+    return 0;
+}
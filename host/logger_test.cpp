@@ -0,0 +1,67 @@
+// The deferred log formatter: conversions, widths and flags, and that every
+// specifier consumes exactly its own argument.
+
+#include <Arduino.h>
+#include "logger.h"
+#include "test.h"
+
+// Collects the formatted message.
+class StringPrint: public Print {
+public:
+    size_t write(uint8_t ch) override {
+        _string += char(ch);
+        return 1;
+    }
+
+    const String& string() const { return _string; }
+
+private:
+    String _string;
+};
+
+template <typename... Args>
+static String formatted(const char* format, const Args&... args) {
+    Logger.log(kLogModuleMain, kLogLevelError, format, args...);
+    StringPrint output;
+    Logger.formatMessage(*Logger.record(Logger.nextSequence() - 1), output);
+    return output.string();
+}
+
+#define CHECK_FORMAT(__expected__, __format__, ...) \
+    do { \
+        String message = formatted(__format__, ##__VA_ARGS__); \
+        CHECK_THAT(message == __expected__, "\"%s\": [%s] instead of [%s]", __format__, message.c_str(), __expected__); \
+    } while (0)
+
+static void testConversions() {
+    CHECK_FORMAT("plain text", "plain text");
+    CHECK_FORMAT("-42 42 FF z", "%d %u %x %c", -42, 42u, 255u, 'z');
+    CHECK_FORMAT("2147483647 -2147483648 4294967295", "%d %d %u", INT32_MAX, INT32_MIN, UINT32_MAX);
+    CHECK_FORMAT("flash and String", "%s and %s", F("flash"), String("String"));
+    CHECK_FORMAT("1h 2m 3s", "%T", TimeInterval::withSeconds(3723));
+    CHECK_FORMAT("100%", "%u%%", 100u);
+}
+
+static void testWidths() {
+    CHECK_FORMAT("4010F000", "%08x", 0x4010f000u);
+    CHECK_FORMAT("00001234", "%08x", 0x1234u);
+    CHECK_FORMAT("12:05:07", "%02u:%02u:%02u", 12u, 5u, 7u);
+    CHECK_FORMAT("   42|  -42|-0042", "%5u|%5d|%05d", 42u, -42, -42);
+    // narrower than the number, and flags other than 0 are ignored
+    CHECK_FORMAT("123456  7", "%3u %-2u", 123456u, 7u);
+}
+
+static void testArguments() {
+    // a width must not swallow the argument of the next conversion
+    CHECK_FORMAT("watchdog reset: software watchdog fired at 40201234 after 5",
+                 "watchdog reset: %s watchdog fired at %08x after %u", F("software"), 0x40201234u, 5u);
+    // a conversion cut short by the end of the format
+    CHECK_FORMAT("cut ", "cut %08", 1u);
+}
+
+int main() {
+    testConversions();
+    testWidths();
+    testArguments();
+    return testResult("logger");
+}
@@ -0,0 +1,82 @@
+// Counts the heap allocations of whole requests, from parsing through
+// authorization and form handling to the response, and prints them as JSON:
+//   ./request_allocs
+//   {"requests":[{"request":"GET /","allocs":7,"peak_heap_bytes":212},...]}
+// The String shim allocates like the core's, see shims/WString.h, so the counts
+// are those of the device.
+
+#include <Arduino.h>
+#include <umm_malloc/umm_malloc.h>
+#include "host_print.h"
+#include "http_request.h"
+#include "request_stream.h"
+#include "webservice.h"
+
+static const char kPageRequest[] =
+    "GET / HTTP/1.1\r\n"
+    "Host: irrigator.local\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/119.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+static const char kStatusRequest[] =
+    "GET /status.json HTTP/1.1\r\n"
+    "Host: irrigator.local\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/119.0\r\n"
+    "Accept: */*\r\n"
+    "Referer: http://irrigator.local/\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+// with the credentials the web service is built with, "*:*"
+static const char kValveRequest[] =
+    "POST /valve/2/ HTTP/1.1\r\n"
+    "Host: irrigator.local\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\n"
+    "Content-Length: 54\r\n"
+    "Authorization: Basic Kjoq\r\n"
+    "\r\n"
+    "is_enabled=on&description=Tomatoes+%26+co&duration=600";
+
+static const char* const kRequests[] = {kPageRequest, kStatusRequest, kValveRequest};
+
+static size_t allocationCount() {
+    return umm_get_malloc_count() + umm_get_realloc_count();
+}
+
+int main() {
+    FilePrint output(stdout);
+    output.print(F("{\"requests\":["));
+
+    for (size_t i = 0; i < sizeof(kRequests) / sizeof(kRequests[0]); ++i) {
+        // the first run fills what is cached across requests
+        for (int run = 0; run < 2; ++run) {
+            umm_free_heap_size_min_reset();
+            size_t freeHeap = umm_free_heap_size();
+            size_t allocations = allocationCount();
+            {
+                RequestStream stream(kRequests[i]);
+                HTTPRequest request(stream);
+                handleRequest(request, stream);
+            }
+            allocations = allocationCount() - allocations;
+
+            if (run == 1) {
+                const char* requestLine = kRequests[i];
+                output.print(i > 0 ? F(",{\"request\":\"") : F("{\"request\":\""));
+                output.write(requestLine, strstr(requestLine, " HTTP/") - requestLine);
+                output.print(F("\",\"allocs\":"));
+                output.print(allocations);
+                output.print(F(",\"peak_heap_bytes\":"));
+                output.print(freeHeap - umm_free_heap_size_lw_min());
+                output.print('}');
+            }
+        }
+    }
+
+    output.println(F("]}"));
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef __request_stream_h
+#define __request_stream_h
+
+#include <Stream.h>
+#include <string.h>
+
+// Replays a request held in memory, and drops whatever is written back.
+class RequestStream: public Stream {
+public:
+    RequestStream(const char* data): _data(data), _length(strlen(data)), _position(0) {}
+
+    int available() override { return _length - _position; }
+    int read() override { return _position < _length ? uint8_t(_data[_position++]) : -1; }
+    int peek() override { return _position < _length ? uint8_t(_data[_position]) : -1; }
+    size_t write(uint8_t ch) override { return 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { return size; }
+
+private:
+    const char* _data;
+    size_t _length;
+    size_t _position;
+};
+
+#endif // __request_stream_h
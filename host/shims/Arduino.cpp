@@ -0,0 +1,39 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+#include "umm_malloc/umm_malloc.h"
+
+EspClass ESP;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+static uint64_t nanosSinceStart() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis() {
+    return uint32_t(nanosSinceStart() / 1000000);
+}
+
+unsigned long micros() {
+    return uint32_t(nanosSinceStart() / 1000);
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {}
+
+uint32_t EspClass::getFreeHeap() {
+    return umm_free_heap_size();
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+    return umm_free_heap_size();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return uint32_t(nanosSinceStart());
+}
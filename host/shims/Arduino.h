@@ -0,0 +1,25 @@
+#ifndef __Arduino_h
+#define __Arduino_h
+
+// What the firmware sources compiled on the host need from the ESP8266 core.
+// Time runs on the host clock, and there are no pins.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Esp.h"
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+#include "pgmspace.h"
+
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+#endif // __Arduino_h
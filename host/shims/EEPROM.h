@@ -0,0 +1,42 @@
+#ifndef __EEPROM_h
+#define __EEPROM_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// An EEPROM image in RAM that is never committed anywhere.
+class EEPROMClass {
+public:
+    static const size_t kCapacity = 4096;
+
+    EEPROMClass(): _data() {}
+
+    void begin(size_t size) {}
+    uint8_t read(int address) const { return _data[address]; }
+    void write(int address, uint8_t value) { _data[address] = value; }
+    bool commit() { return true; }
+
+    uint8_t* getDataPtr() { return _data; }
+    const uint8_t* getConstDataPtr() const { return _data; }
+    size_t length() const { return kCapacity; }
+
+    template <typename T>
+    T& get(int address, T& value) const {
+        memcpy(&value, _data + address, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& value) {
+        memcpy(_data + address, &value, sizeof(T));
+        return value;
+    }
+
+private:
+    uint8_t _data[kCapacity];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // __EEPROM_h
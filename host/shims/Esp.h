@@ -0,0 +1,20 @@
+#ifndef __Esp_h
+#define __Esp_h
+
+#include <stdint.h>
+
+class EspClass {
+public:
+    // from the heap statistics, see umm_malloc/umm_malloc.h
+    uint32_t getFreeHeap();
+    uint32_t getMaxFreeBlockSize();
+
+    // The host clock in nanoseconds, as the cycle counter of a 1000MHz CPU, so
+    // that cycles convert to time as they do on the device. It wraps after 4s.
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 1000; }
+};
+
+extern EspClass ESP;
+
+#endif // __Esp_h
@@ -0,0 +1,20 @@
+#ifndef __IPAddress_h
+#define __IPAddress_h
+
+#include <stdint.h>
+
+class IPAddress {
+public:
+    IPAddress(): _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d):
+        _address(uint32_t(a) | uint32_t(b) << 8 | uint32_t(c) << 16 | uint32_t(d) << 24) {}
+    IPAddress(uint32_t address): _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    bool isSet() const { return _address != 0; }
+
+private:
+    uint32_t _address;
+};
+
+#endif // __IPAddress_h
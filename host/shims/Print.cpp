@@ -0,0 +1,109 @@
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size-- > 0 && write(*buffer++) == 1) {
+        ++written;
+    }
+    return written;
+}
+
+static size_t printFormatted(Print& output, const char* format, va_list arguments) {
+    char text[128];
+    va_list copy;
+    va_copy(copy, arguments);
+    int length = vsnprintf(text, sizeof(text), format, copy);
+    va_end(copy);
+    if (length < 0) {
+        return 0;
+    }
+    if (size_t(length) < sizeof(text)) {
+        return output.write(text, length);
+    }
+
+    String longer;
+    longer.reserve(length);
+    vsnprintf(longer.begin(), length + 1, format, arguments);
+    return output.write(longer.begin(), length);
+}
+
+size_t Print::printf(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    size_t written = printFormatted(*this, format, arguments);
+    va_end(arguments);
+    return written;
+}
+
+size_t Print::printf_P(PGM_P format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    size_t written = printFormatted(*this, format, arguments);
+    va_end(arguments);
+    return written;
+}
+
+size_t Print::print(const __FlashStringHelper* str) {
+    return write(reinterpret_cast<const char*>(str));
+}
+
+size_t Print::print(const String& str) {
+    return write(str.c_str(), str.length());
+}
+
+size_t Print::print(const char* str) {
+    return write(str);
+}
+
+size_t Print::print(char ch) {
+    return write(uint8_t(ch));
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(int value, int base) {
+    return print(static_cast<long long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(long value, int base) {
+    return print(static_cast<long long>(value), base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(long long value, int base) {
+    if (base == DEC && value < 0) {
+        return print('-') + print(0ULL - static_cast<unsigned long long>(value), base);
+    }
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+    if (base < 2 || base > 16) {
+        base = DEC;
+    }
+
+    char digits[8 * sizeof(value)];
+    char* start = digits + sizeof(digits);
+    do {
+        *--start = "0123456789ABCDEF"[value % base];
+        value /= base;
+    } while (value > 0);
+
+    return write(start, digits + sizeof(digits) - start);
+}
+
+size_t Print::print(double value, int digits) {
+    return printf("%.*f", digits, value);
+}
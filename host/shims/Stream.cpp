@@ -0,0 +1,59 @@
+#include "Stream.h"
+
+bool Stream::find(const char* target) {
+    size_t targetLength = strlen(target);
+    if (targetLength == 0) {
+        return true;
+    }
+
+    // a naive restart is enough for the single character targets the firmware uses
+    size_t matched = 0;
+    for (int ch; (ch = read()) >= 0; ) {
+        if (ch == target[matched]) {
+            if (++matched == targetLength) {
+                return true;
+            }
+        }
+        else {
+            matched = ch == target[0] ? 1 : 0;
+        }
+    }
+    return false;
+}
+
+bool Stream::find(char target) {
+    char str[] = {target, 0};
+    return find(str);
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    for (int ch; count < length && (ch = read()) >= 0; ) {
+        buffer[count++] = ch;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t count = 0;
+    for (int ch; count < length && (ch = read()) >= 0 && ch != terminator; ) {
+        buffer[count++] = ch;
+    }
+    return count;
+}
+
+String Stream::readString() {
+    String str;
+    for (int ch; (ch = read()) >= 0; ) {
+        str += char(ch);
+    }
+    return str;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String str;
+    for (int ch; (ch = read()) >= 0 && ch != terminator; ) {
+        str += char(ch);
+    }
+    return str;
+}
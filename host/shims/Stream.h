@@ -0,0 +1,35 @@
+#ifndef __Stream_h
+#define __Stream_h
+
+#include "Print.h"
+
+// Reads do not wait: on the host every stream is in memory, so a read that
+// comes back empty means the data has run out rather than that it is late.
+class Stream: public Print {
+public:
+    Stream(): _timeout(1000) {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    bool find(const char* target);
+    bool find(char target);
+
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        return readBytes(reinterpret_cast<char*>(buffer), length);
+    }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+
+    String readString();
+    String readStringUntil(char terminator);
+
+protected:
+    unsigned long _timeout;
+};
+
+#endif // __Stream_h
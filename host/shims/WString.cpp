@@ -0,0 +1,356 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "umm_malloc/umm_malloc.h"
+
+String::String(const char* str): _heap(nullptr), _length(0), _capacity(kInlineCapacity) {
+    _inline[0] = 0;
+    if (str) {
+        concat(str, strlen(str));
+    }
+}
+
+String::String(const char* str, size_t length): String() {
+    concat(str, length);
+}
+
+String::String(const __FlashStringHelper* str): String(reinterpret_cast<const char*>(str)) {}
+
+String::String(const String& other): String() {
+    concat(other);
+}
+
+String::String(String&& other): String() {
+    move(other);
+}
+
+String::String(char ch): String() {
+    concat(ch);
+}
+
+String::String(unsigned char value, unsigned char base): String(static_cast<unsigned long>(value), base) {}
+String::String(int value, unsigned char base): String(static_cast<long>(value), base) {}
+String::String(unsigned int value, unsigned char base): String(static_cast<unsigned long>(value), base) {}
+
+String::String(long value, unsigned char base): String() {
+    char digits[2 + 8 * sizeof(long)];
+    if (base == 10) {
+        snprintf(digits, sizeof(digits), "%ld", value);
+    }
+    else {
+        snprintf(digits, sizeof(digits), base == 16 ? "%lx" : "%lo", value);
+    }
+    concat(digits);
+}
+
+String::String(unsigned long value, unsigned char base): String() {
+    char digits[2 + 8 * sizeof(long)];
+    snprintf(digits, sizeof(digits), base == 16 ? "%lx" : base == 8 ? "%lo" : "%lu", value);
+    concat(digits);
+}
+
+String::String(double value, unsigned char decimals): String() {
+    char digits[64];
+    snprintf(digits, sizeof(digits), "%.*f", decimals, value);
+    concat(digits);
+}
+
+String::~String() {
+    umm_free(_heap);
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) {
+        invalidate();
+        concat(other);
+    }
+    return *this;
+}
+
+String& String::operator=(String&& other) {
+    if (this != &other) {
+        move(other);
+    }
+    return *this;
+}
+
+String& String::operator=(const char* str) {
+    invalidate();
+    concat(str);
+    return *this;
+}
+
+String& String::operator=(const __FlashStringHelper* str) {
+    return *this = reinterpret_cast<const char*>(str);
+}
+
+void String::invalidate() {
+    _length = 0;
+    buffer()[0] = 0;
+}
+
+void String::move(String& other) {
+    if (other._heap) {
+        umm_free(_heap);
+        _heap = other._heap;
+        _length = other._length;
+        _capacity = other._capacity;
+        other._heap = nullptr;
+        other._capacity = kInlineCapacity;
+        other.invalidate();
+    }
+    else {
+        invalidate();
+        concat(other);
+        other.invalidate();
+    }
+}
+
+bool String::reserve(unsigned int capacity) {
+    if (capacity <= _capacity) {
+        return true;
+    }
+
+    char* heap = static_cast<char*>(umm_realloc(_heap, capacity + 1));
+    if (!heap) {
+        return false;
+    }
+    if (!_heap) {
+        memcpy(heap, _inline, _length + 1);
+    }
+
+    _heap = heap;
+    _capacity = capacity;
+    return true;
+}
+
+bool String::concat(const char* str, unsigned int length) {
+    if (!str) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+
+    // str may point into this string, which reserving can move
+    const char* data = buffer();
+    bool isInside = str >= data && str <= data + _length;
+    size_t offset = str - data;
+    if (!reserve(_length + length)) {
+        return false;
+    }
+    if (isInside) {
+        str = buffer() + offset;
+    }
+
+    memmove(buffer() + _length, str, length);
+    _length += length;
+    buffer()[_length] = 0;
+    return true;
+}
+
+bool String::concat(const char* str) {
+    return str && concat(str, strlen(str));
+}
+
+bool String::concat(const __FlashStringHelper* str) {
+    return concat(reinterpret_cast<const char*>(str));
+}
+
+bool String::concat(const String& str) {
+    return concat(str.c_str(), str.length());
+}
+
+bool String::concat(char ch) {
+    return concat(&ch, 1);
+}
+
+bool String::concat(unsigned char value) { return concat(String(value)); }
+bool String::concat(int value) { return concat(String(value)); }
+bool String::concat(unsigned int value) { return concat(String(value)); }
+bool String::concat(long value) { return concat(String(value)); }
+bool String::concat(unsigned long value) { return concat(String(value)); }
+bool String::concat(double value) { return concat(String(value)); }
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= _length) {
+        dummy = 0;
+        return dummy;
+    }
+    return buffer()[index];
+}
+
+int String::compareTo(const String& other) const {
+    return strcmp(c_str(), other.c_str());
+}
+
+bool String::equals(const String& other) const {
+    return _length == other._length && memcmp(c_str(), other.c_str(), _length) == 0;
+}
+
+bool String::equals(const char* str) const {
+    return strcmp(c_str(), str ? str : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    return _length == other._length && strcasecmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return prefix._length <= _length && memcmp(c_str(), prefix.c_str(), prefix._length) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return suffix._length <= _length &&
+        memcmp(c_str() + _length - suffix._length, suffix.c_str(), suffix._length) == 0;
+}
+
+int String::indexOf(char ch, unsigned int from) const {
+    if (from >= _length) {
+        return -1;
+    }
+    const char* found = static_cast<const char*>(memchr(c_str() + from, ch, _length - from));
+    return found ? found - c_str() : -1;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    if (from > _length) {
+        return -1;
+    }
+    const char* found = strstr(c_str() + from, str.c_str());
+    return found ? found - c_str() : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+    const char* found = strrchr(c_str(), ch);
+    return found ? found - c_str() : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int swapped = from;
+        from = to;
+        to = swapped;
+    }
+    if (from >= _length) {
+        return String();
+    }
+    if (to > _length) {
+        to = _length;
+    }
+    return String(c_str() + from, to - from);
+}
+
+void String::remove(unsigned int index) {
+    remove(index, _length);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= _length) {
+        return;
+    }
+    if (count > _length - index) {
+        count = _length - index;
+    }
+    memmove(buffer() + index, buffer() + index + count, _length - index - count + 1);
+    _length -= count;
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find._length == 0) {
+        return;
+    }
+
+    String result;
+    const char* start = c_str();
+    for (const char* found; (found = strstr(start, find.c_str())); start = found + find._length) {
+        result.concat(start, found - start);
+        result.concat(replacement);
+    }
+    result.concat(start);
+    *this = static_cast<String&&>(result);
+}
+
+void String::trim() {
+    unsigned int start = 0;
+    while (start < _length && isspace(static_cast<unsigned char>(buffer()[start]))) {
+        ++start;
+    }
+    unsigned int end = _length;
+    while (end > start && isspace(static_cast<unsigned char>(buffer()[end - 1]))) {
+        --end;
+    }
+    remove(end);
+    remove(0, start);
+}
+
+void String::toLowerCase() {
+    for (char& ch: *this) {
+        ch = tolower(static_cast<unsigned char>(ch));
+    }
+}
+
+void String::toUpperCase() {
+    for (char& ch: *this) {
+        ch = toupper(static_cast<unsigned char>(ch));
+    }
+}
+
+long String::toInt() const {
+    return atol(c_str());
+}
+
+float String::toFloat() const {
+    return atof(c_str());
+}
+
+void String::toCharArray(char* buffer, unsigned int size, unsigned int index) const {
+    getBytes(reinterpret_cast<unsigned char*>(buffer), size, index);
+}
+
+void String::getBytes(unsigned char* buffer, unsigned int size, unsigned int index) const {
+    if (size == 0) {
+        return;
+    }
+    if (index >= _length) {
+        buffer[0] = 0;
+        return;
+    }
+    unsigned int length = _length - index < size - 1 ? _length - index : size - 1;
+    memcpy(buffer, c_str() + index, length);
+    buffer[length] = 0;
+}
+
+String operator+(const String& lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, const __FlashStringHelper* rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
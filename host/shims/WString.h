@@ -0,0 +1,123 @@
+#ifndef __WString_h
+#define __WString_h
+
+// The subset of the Arduino String the firmware uses, allocating like the
+// ESP8266 core 3.x one: up to 11 characters are kept inline, longer strings
+// go to the heap with exactly the capacity asked for. The heap is counted,
+// see umm_malloc/umm_malloc.h.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "pgmspace.h"
+
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#define F(s) FPSTR(PSTR(s))
+
+class String {
+public:
+    String(const char* str = "");
+    String(const char* str, size_t length);
+    String(const __FlashStringHelper* str);
+    String(const String& other);
+    String(String&& other);
+    explicit String(char ch);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(double value, unsigned char decimals = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(String&& other);
+    String& operator=(const char* str);
+    String& operator=(const __FlashStringHelper* str);
+
+    bool reserve(unsigned int capacity);
+    unsigned int length() const { return _length; }
+    bool isEmpty() const { return _length == 0; }
+
+    bool concat(const char* str, unsigned int length);
+    bool concat(const char* str);
+    bool concat(const __FlashStringHelper* str);
+    bool concat(const String& str);
+    bool concat(char ch);
+    bool concat(unsigned char value);
+    bool concat(int value);
+    bool concat(unsigned int value);
+    bool concat(long value);
+    bool concat(unsigned long value);
+    bool concat(double value);
+
+    template <typename T>
+    String& operator+=(const T& value) {
+        concat(value);
+        return *this;
+    }
+
+    const char* c_str() const { return buffer(); }
+    char* begin() { return buffer(); }
+    char* end() { return buffer() + _length; }
+    const char* begin() const { return buffer(); }
+    const char* end() const { return buffer() + _length; }
+
+    char charAt(unsigned int index) const { return index < _length ? buffer()[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index);
+
+    int compareTo(const String& other) const;
+    bool equals(const String& other) const;
+    bool equals(const char* str) const;
+    bool equalsIgnoreCase(const String& other) const;
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* str) const { return equals(str); }
+    bool operator==(const __FlashStringHelper* str) const { return equals(reinterpret_cast<const char*>(str)); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* str) const { return !equals(str); }
+    bool operator<(const String& other) const { return compareTo(other) < 0; }
+
+    int indexOf(char ch, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    int lastIndexOf(char ch) const;
+    String substring(unsigned int from) const { return substring(from, _length); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void replace(const String& find, const String& replacement);
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+
+    long toInt() const;
+    float toFloat() const;
+    void toCharArray(char* buffer, unsigned int size, unsigned int index = 0) const;
+    void getBytes(unsigned char* buffer, unsigned int size, unsigned int index = 0) const;
+
+private:
+    static const unsigned int kInlineCapacity = 11;
+
+    char* buffer() { return _heap ? _heap : _inline; }
+    const char* buffer() const { return _heap ? _heap : _inline; }
+    void invalidate();
+    void move(String& other);
+
+private:
+    char* _heap;
+    unsigned int _length;
+    unsigned int _capacity;
+    char _inline[kInlineCapacity + 1];
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const String& lhs, const __FlashStringHelper* rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const char* lhs, const String& rhs);
+
+#endif // __WString_h
@@ -0,0 +1,29 @@
+#ifndef __pgmspace_h
+#define __pgmspace_h
+
+// The host has no separate flash address space, flash data is ordinary memory.
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t*>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t*>(address))
+#define pgm_read_dword(address) (*reinterpret_cast<const uint32_t*>(address))
+
+#define strlen_P strlen
+#define strnlen_P strnlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strncasecmp_P strncasecmp
+#define strstr_P strstr
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define memcmp_P memcmp
+#define memcpy_P memcpy
+
+#endif // __pgmspace_h
@@ -0,0 +1,89 @@
+#include "umm_malloc.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Each block carries its size in front, so that the bytes in use can be tracked.
+struct BlockHeader {
+    size_t size;
+    size_t padding;
+};
+
+static size_t bytesInUse;
+static size_t bytesInUseHighWater;
+static size_t mallocCount;
+static size_t reallocCount;
+static size_t freeCount;
+
+static void track(size_t allocated, size_t freed) {
+    bytesInUse += allocated - freed;
+    if (bytesInUse > bytesInUseHighWater) {
+        bytesInUseHighWater = bytesInUse;
+    }
+}
+
+void* umm_malloc(size_t size) {
+    BlockHeader* header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + size));
+    if (!header) {
+        return nullptr;
+    }
+
+    header->size = size;
+    ++mallocCount;
+    track(size, 0);
+    return header + 1;
+}
+
+void* umm_realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return umm_malloc(size);
+    }
+
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    size_t previousSize = header->size;
+    header = static_cast<BlockHeader*>(realloc(header, sizeof(BlockHeader) + size));
+    if (!header) {
+        return nullptr;
+    }
+
+    header->size = size;
+    ++reallocCount;
+    track(size, previousSize);
+    return header + 1;
+}
+
+void umm_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    ++freeCount;
+    track(0, header->size);
+    free(header);
+}
+
+size_t umm_free_heap_size(void) {
+    return UMM_HOST_HEAP_SIZE - bytesInUse;
+}
+
+size_t umm_free_heap_size_lw_min(void) {
+    return UMM_HOST_HEAP_SIZE - bytesInUseHighWater;
+}
+
+size_t umm_free_heap_size_min_reset(void) {
+    bytesInUseHighWater = bytesInUse;
+    return umm_free_heap_size();
+}
+
+size_t umm_get_malloc_count(void) {
+    return mallocCount;
+}
+
+size_t umm_get_realloc_count(void) {
+    return reallocCount;
+}
+
+size_t umm_get_free_count(void) {
+    return freeCount;
+}
@@ -0,0 +1,34 @@
+#ifndef __umm_malloc_h
+#define __umm_malloc_h
+
+// Heap statistics in the shape of those umm_malloc keeps with UMM_STATS_FULL.
+// On the host they cover the allocations of String, which is all the heap
+// the firmware code uses directly.
+
+#include <stddef.h>
+
+#define UMM_STATS_FULL 1
+
+// the size of the heap the free counts are taken from, about what the firmware has left
+#define UMM_HOST_HEAP_SIZE 40960
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* umm_malloc(size_t size);
+void* umm_realloc(void* ptr, size_t size);
+void umm_free(void* ptr);
+
+size_t umm_free_heap_size(void);
+size_t umm_free_heap_size_lw_min(void);
+size_t umm_free_heap_size_min_reset(void);
+size_t umm_get_malloc_count(void);
+size_t umm_get_realloc_count(void);
+size_t umm_get_free_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __umm_malloc_h
@@ -0,0 +1,171 @@
+// The base64 and percent codecs: RFC 4648 vectors, malformed input, every one
+// and two byte input and pseudo-random inputs fed in block splitting pieces.
+// Then the escaping of user data into JSON and HTML.
+
+#include <Arduino.h>
+#include "string_ext.h"
+#include "test.h"
+
+// Collects output in a fixed buffer, so that the tests do not depend on
+// String allocations.
+class BufferPrint: public Print {
+public:
+    BufferPrint(): _length(0) {}
+
+    size_t write(uint8_t ch) override {
+        return write(&ch, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (_length + size > sizeof(_buffer)) {
+            size = sizeof(_buffer) - _length;
+        }
+        memcpy(_buffer + _length, buffer, size);
+        _length += size;
+        return size;
+    }
+
+    const uint8_t* data() const { return _buffer; }
+    size_t length() const { return _length; }
+
+private:
+    uint8_t _buffer[768];
+    size_t _length;
+};
+
+static bool roundTrips(const uint8_t* data, size_t length, size_t chunkSize) {
+    BufferPrint encoded;
+    Base64Encoder encoder(encoded);
+    for (size_t i = 0; i < length; i += chunkSize) {
+        encoder.write(data + i, i + chunkSize <= length ? chunkSize : length - i);
+    }
+    encoder.finish();
+
+    if (encoded.length() != (length + 2) / 3 * 4) {
+        return false;
+    }
+
+    BufferPrint decoded;
+    Base64Decoder decoder(decoded);
+    const char* chars = reinterpret_cast<const char*>(encoded.data());
+    for (size_t i = 0; i < encoded.length(); i += chunkSize) {
+        decoder.write(chars + i, i + chunkSize <= encoded.length() ? chunkSize : encoded.length() - i);
+    }
+
+    return decoder.finish() && decoded.length() == length && memcmp(decoded.data(), data, length) == 0;
+}
+
+static bool decodes(const char* src) {
+    BufferPrint decoded;
+    Base64Decoder decoder(decoded);
+    decoder.write(src, strlen(src));
+    return decoder.finish();
+}
+
+static void testBase64() {
+    static const char* const kVectors[][2] = {
+        {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+    };
+    static const char* const kMalformed[] = {
+        "Zg", "Zg=", "Z===", "====", "Zh==", "Zm9=", "Zg==Zg==", "Zg=A", "Zm9v!A==", "Zm 9v",
+    };
+
+    for (const auto& vector : kVectors) {
+        String encoded, decoded;
+        base64Encode(vector[0], encoded);
+        CHECK_THAT(encoded == vector[1] && base64Decode(encoded, decoded) && decoded == vector[0],
+                   "base64: vector [%s] failed", vector[0]);
+    }
+
+    for (const char* input : kMalformed) {
+        CHECK_THAT(!decodes(input), "base64: accepted [%s]", input);
+    }
+
+    // every input of up to two bytes, in one piece
+    uint8_t data[256];
+    for (uint32_t i = 0; i < 0x10000 + 0x100; ++i) {
+        size_t length = i < 0x100 ? 1 : 2;
+        uint32_t value = i < 0x100 ? i : i - 0x100;
+        data[0] = value;
+        data[1] = value >> 8;
+        CHECK_THAT(roundTrips(data, length, length), "base64: %zu byte input %x failed", length, value);
+    }
+
+    // pseudo-random inputs of every length, fed in pieces that split blocks
+    uint32_t seed = 1;
+    for (size_t length = 0; length <= sizeof(data); ++length) {
+        for (size_t i = 0; i < length; ++i) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = seed >> 16;
+        }
+        for (size_t chunkSize = 1; chunkSize <= 7; ++chunkSize) {
+            CHECK_THAT(roundTrips(data, length, chunkSize),
+                       "base64: length %zu in chunks of %zu failed", length, chunkSize);
+        }
+    }
+}
+
+static void testPercent() {
+    static const char* const kVectors[][2] = {
+        {"", ""}, {"abc-._~XYZ09", "abc-._~XYZ09"}, {"a b", "a%20b"}, {"100%", "100%25"},
+        {"[main] cycle", "%5Bmain%5D%20cycle"}, {"\xff\x01", "%FF%01"},
+    };
+    static const char* const kMalformed[] = {"%", "%4", "%G0", "a%2"};
+
+    char buffer[64];
+
+    for (const auto& vector : kVectors) {
+        size_t length = percentEncode(vector[0], strlen(vector[0]), buffer, sizeof(buffer));
+        bool isEncoded = length == strlen(vector[1]) && memcmp(buffer, vector[1], length) == 0 &&
+            length == percentEncodedLength(vector[0], strlen(vector[0]));
+        int decodedLength = percentDecode(buffer, length, buffer, false);
+        CHECK_THAT(isEncoded && decodedLength == int(strlen(vector[0])) &&
+                   memcmp(buffer, vector[0], decodedLength) == 0,
+                   "percent: vector [%s] failed", vector[1]);
+    }
+
+    for (const char* input : kMalformed) {
+        CHECK_THAT(percentDecode(input, strlen(input), buffer, false) < 0, "percent: accepted [%s]", input);
+    }
+
+    CHECK(percentDecode("a+b%2B", 6, buffer, true) == 4 && memcmp(buffer, "a b+", 4) == 0);
+
+    // every byte value round trips, also through the streaming encoder
+    char all[256];
+    for (int i = 0; i < 256; ++i) {
+        all[i] = i;
+    }
+    char decoded[256];
+    BufferPrint encoded;
+    percentEncode(all, sizeof(all), encoded);
+    int decodedLength = percentDecode(reinterpret_cast<const char*>(encoded.data()), encoded.length(), decoded, false);
+    CHECK(encoded.length() == percentEncodedLength(all, sizeof(all)));
+    CHECK(decodedLength == sizeof(all) && memcmp(decoded, all, sizeof(all)) == 0);
+}
+
+static bool writes(size_t (*escape)(const char*, size_t, Print&), const char* src, const char* expected) {
+    BufferPrint output;
+    size_t length = escape(src, strlen(src), output);
+    return length == strlen(expected) && output.length() == length && memcmp(output.data(), expected, length) == 0;
+}
+
+static void testEscaping() {
+    CHECK(writes(writeJSONString, "", "\"\""));
+    CHECK(writes(writeJSONString, "Bed 1", "\"Bed 1\""));
+    CHECK(writes(writeJSONString, "a\"b\\c", "\"a\\\"b\\\\c\""));
+    CHECK(writes(writeJSONString, "\n\x1f", "\"\\u000A\\u001F\""));
+    CHECK(writes(writeJSONString, "</script>&", "\"\\u003C/script\\u003E\\u0026\""));
+
+    CHECK(writes(writeHTMLEscaped, "", ""));
+    CHECK(writes(writeHTMLEscaped, "/valve/1/", "/valve/1/"));
+    CHECK(writes(writeHTMLEscaped, "\"><script>", "&quot;&gt;&lt;script&gt;"));
+    CHECK(writes(writeHTMLEscaped, "a&b'c", "a&amp;b&#39;c"));
+}
+
+int main() {
+    testBase64();
+    testPercent();
+    testEscaping();
+    return testResult("string_ext");
+}
@@ -0,0 +1,44 @@
+#ifndef __test_h
+#define __test_h
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// Checks for the host tests, one test program per module. A failed check is
+// reported with its location and the program exits non-zero at the end.
+
+static int testFailureCount;
+
+static void testFail(const char* file, int line, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+static void testFail(const char* file, int line, const char* format, ...) {
+    fprintf(stderr, "%s:%d: ", file, line);
+    va_list arguments;
+    va_start(arguments, format);
+    vfprintf(stderr, format, arguments);
+    va_end(arguments);
+    fputc('\n', stderr);
+    ++testFailureCount;
+}
+
+#define CHECK(__condition__) \
+    do { \
+        if (!(__condition__)) { \
+            testFail(__FILE__, __LINE__, "check failed: %s", #__condition__); \
+        } \
+    } while (0)
+
+// with a message of its own, for checks run in a loop
+#define CHECK_THAT(__condition__, __format__, ...) \
+    do { \
+        if (!(__condition__)) { \
+            testFail(__FILE__, __LINE__, __format__, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+static int testResult(const char* name) {
+    printf("%s: %d failures\n", name, testFailureCount);
+    return testFailureCount == 0 ? 0 : 1;
+}
+
+#endif // __test_h
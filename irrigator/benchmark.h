@@ -0,0 +1,34 @@
+#ifndef __benchmark_h
+#define __benchmark_h
+
+#include "common.h"
+
+#if DEBUG
+
+class HTTPRequest;
+class Print;
+
+// the most requests a load run replays
+static const int kMaxLoadRequests = 128;
+
+// Runs the hot path benchmarks and prints the results as one JSON object, so that
+// firmware revisions can be compared before they are rolled out. It is built for
+// the host as well, see host/, where the comparison needs no device:
+//   {"firmware":2,"cpu_mhz":80,"benchmarks":[{"name":"parse_request","iterations":100,
+//    "ns_per_op":412000,"allocs_per_op":8,"peak_heap_bytes":640},...]}
+// On the device, allocation counts need a core built with UMM_STATS_FULL and are
+// null otherwise. The suite blocks the loop for well under a second.
+extern void runBenchmarks(Print& output);
+
+// Replays a mix of status page views, valve updates, requests with bad
+// credentials and malformed requests through handleRequest(), from memory, and
+// prints throughput, latency percentiles and heap high-water per request type as
+// JSON. The valve updates write back the current settings with the credentials
+// of origin, so a run changes nothing. Whether a valve task was active is part
+// of the output. That can only be a command from the ValveQueue: the duty cycle
+// blocks the loop until it is done, so nothing is served while one runs.
+extern void runLoad(const HTTPRequest& origin, int requestCount, Print& output);
+
+#endif
+
+#endif // __benchmark_h
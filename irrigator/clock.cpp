@@ -3,33 +3,145 @@
 #include <EEPROM.h>
 #include <ESP8266WiFi.h>
 #include <WiFiUdp.h>
+extern "C" {
+#include <lwip/dns.h>
+#include <user_interface.h>
+}
 #include "common.h"
+#include "persistence.h"
+#include "string_ext.h"
 
 #if DEBUG
-static const TimeInterval kSyncRetryInterval = TimeInterval::withSeconds(10);
-static const TimeInterval kSyncInterval = TimeInterval::withSeconds(60);
-static const TimeInterval kUptimeSaveInterval = TimeInterval::withSeconds(30);
+static constexpr TimeInterval kSyncRetryInterval = 10_s;
+static constexpr TimeInterval kMinSyncInterval = 1_min;
+static constexpr TimeInterval kMaxSyncInterval = 15_min;
+static constexpr TimeInterval kUptimeSaveInterval = 30_s;
 #else
-static const TimeInterval kSyncRetryInterval = TimeInterval::withSeconds(60);
-static const TimeInterval kSyncInterval = TimeInterval::withSeconds(60 * 60 * 24);
-static const TimeInterval kUptimeSaveInterval = TimeInterval::withSeconds(60 * 60);
+static constexpr TimeInterval kSyncRetryInterval = 1_min;
+static constexpr TimeInterval kMinSyncInterval = 1_h;
+static constexpr TimeInterval kMaxSyncInterval = 96_h;
+static constexpr TimeInterval kUptimeSaveInterval = 1_h;
 #endif
 
-static const char* kNTPServerName = "hu.pool.ntp.org";
+// the sync interval is doubled while the clock stays within kResidualTolerance
+// of network time, and halved when it drifts beyond kResidualLimit
+static constexpr TimeInterval kResidualTolerance = 50_ms;
+static constexpr TimeInterval kResidualLimit = 250_ms;
+static constexpr TimeInterval kMaxRoundTripDelay = 1_s;
+static constexpr TimeInterval kSyncRoundTimeout = 2_s;
+static const int32_t kMaxFrequencyErrorPPM = 500;
+// replies of a running round are collected by polling
+static constexpr TimeInterval kSyncRoundPollInterval = 20_ms;
+
+static constexpr char kNTPServerNames[] PROGMEM = "0.hu.pool.ntp.org\0" "1.hu.pool.ntp.org\0" "2.hu.pool.ntp.org";
+static const int kNumNTPServers = flashStringCount(kNTPServerNames, sizeof(kNTPServerNames));
 
 static const int kNTPPort = 123;
 static const int kNTPPacketSize = 48;
 static const int kLocalNTPPort = 2390;
 
+static const int kNTPOriginateTimestampOffset = 24;
+static const int kNTPReceiveTimestampOffset = 32;
+static const int kNTPTransmitTimestampOffset = 40;
+static const int kNTPTimestampSize = 8;
+
+static const uint8_t kNTPModeServer = 4;
+static const uint8_t kNTPLeapIndicatorUnsynchronized = 3;
+
 static const unsigned long kUnixEpochStartSeconds = 2208988800UL;
 
+static const uint32_t kRTCStateMagic = 0x434c4f4b; // "CLOK"
+
+struct ClockRTCState {
+    uint32_t magic;
+    int32_t frequencyErrorPPM;
+    int32_t syncIntervalSeconds;
+    uint32_t checksum;
+    // at the planned wake-up, the Unix time is -1 if the clock was isolated
+    int64_t cumulativeTicks;
+    int64_t unixTicks;
+};
+
+static_assert(kRTCClockState + sizeof(ClockRTCState) / sizeof(uint32_t) <= kRTCEnd,
+              "the clock state overlaps the next RTC memory region");
+
+static uint32_t checksum(const ClockRTCState& state) {
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(&state);
+    uint32_t sum = 0;
+
+    for (unsigned i = 0; i < sizeof(state) / sizeof(uint32_t); ++i) {
+        if (&words[i] != &state.checksum) {
+            sum = (sum << 1 | sum >> 31) ^ words[i];
+        }
+    }
+
+    return sum;
+}
+
+typedef enum {
+    kRequestIdle = 0,
+    kRequestResolving,
+    kRequestResolved,
+    kRequestSent,
+    kRequestAnswered,
+    kRequestFailed
+} SNTPRequestState;
+
+struct SNTPRequest {
+    // written from the DNS callback
+    volatile uint8_t state;
+    IPAddress address;
+
+    DeviceTime transmitTime;
+    uint8_t transmitTimestamp[kNTPTimestampSize];
+
+    UnixTime startupTime;
+    TimeInterval roundTripDelay;
+    DeviceTime receiveTime;
+
+    SNTPRequest():
+        state(kRequestIdle),
+        transmitTime(DeviceTime::distantPast()),
+        startupTime(UnixTime::distantPast()),
+        roundTripDelay(TimeInterval::withSeconds(0)),
+        receiveTime(DeviceTime::distantPast()) {}
+};
+
 ClockClass Clock;
 
 WiFiUDP udp;
+bool isUDPOpen = false;
 uint8_t packetBuffer[kNTPPacketSize];
+SNTPRequest requests[kNumNTPServers];
+
+static uint32_t readUInt32(const uint8_t* ptr) {
+    return (uint32_t(ptr[0]) << 24) | (uint32_t(ptr[1]) << 16) | (uint32_t(ptr[2]) << 8) | ptr[3];
+}
+
+static void writeUInt32(uint8_t* ptr, uint32_t value) {
+    ptr[0] = value >> 24;
+    ptr[1] = value >> 16;
+    ptr[2] = value >> 8;
+    ptr[3] = value;
+}
+
+static TimeInterval timeIntervalFromNTPTimestamp(const uint8_t* ptr) {
+    uint32_t seconds = readUInt32(ptr) - kUnixEpochStartSeconds;
+    uint32_t fraction = readUInt32(ptr + 4);
+    return TimeInterval::withTicks((int64_t(seconds) << TimeInterval::kNumFractionBits) |
+                                   (fraction >> (32 - TimeInterval::kNumFractionBits)));
+}
+
+// the transmit timestamp carries the local device time; the server echoes it back
+// as the originate timestamp, which identifies the reply
+static void encodeNTPTimestamp(const DeviceTime& dt, uint8_t* ptr) {
+    const TimeInterval& ti = dt.timeIntervalSinceReferenceTime();
+    writeUInt32(ptr, ti.seconds());
+    writeUInt32(ptr + 4, uint32_t(ti._ticks & TimeInterval::kFractionMask) << (32 - TimeInterval::kNumFractionBits));
+}
 
 // send an NTP request to the time server at the given address
-static void sendNTPPacket(IPAddress& address) {
+static void sendNTPPacket(const IPAddress& address, const uint8_t* transmitTimestamp) {
     // set all bytes in the buffer to 0
     memset(packetBuffer, 0, kNTPPacketSize);
     // Initialize values needed to form NTP request
@@ -42,6 +154,7 @@ static void sendNTPPacket(IPAddress& address) {
     packetBuffer[13] = 0x4E;
     packetBuffer[14] = 49;
     packetBuffer[15] = 52;
+    memcpy(packetBuffer + kNTPTransmitTimestampOffset, transmitTimestamp, kNTPTimestampSize);
 
     udp.beginPacket(address, kNTPPort);
     udp.write(packetBuffer, kNTPPacketSize);
@@ -52,134 +165,463 @@ ClockClass::ClockClass():
     _lastSuccessfulSyncTime(DeviceTime::distantPast()), 
     _lastSyncTrialTime(DeviceTime::distantPast()), 
     _lastUptimeSaveTime(DeviceTime::distantPast()),
+    _syncRoundDeadline(DeviceTime::distantPast()),
+    _isSyncing(false),
+    _isResyncRequested(false),
     _startupTime(UnixTime::distantPast()),
     _firstStartupTime(UnixTime::distantPast()),
     _previousUptime(TimeInterval::withSeconds(0)),
-    _systemMillisOverflow(0),
-    _lastSeenSystemMillis(0) {
-    
-    _lastUptimeSaveTime = deviceTime();
+    _syncInterval(kMinSyncInterval),
+    _frequencyErrorPPM(0),
+    _snapshot(DeviceTime::distantPast()),
+    _deviceTicks(0),
+    _deviceTicksResidue(0),
+    _lastSeenSystemMillis(millis()) {
+
+    _deviceTicks = DeviceTime(_lastSeenSystemMillis).timeIntervalSinceReferenceTime()._ticks;
+    _snapshot = deviceTime();
+    _lastUptimeSaveTime = _snapshot;
 }
 
 bool ClockClass::sync() {
-    DeviceTime localTime = deviceTime();
-    LOG(String(F("[Clock] Device time is: ")) + 
-        localTime.timeIntervalSinceReferenceTime().toHumanReadableString() + 
-        " (" + String(localTime.timeIntervalSinceReferenceTime().seconds()) + ")\n");
-    CumulativeTime ct = cumulativeTime();
-    LOG(String(F("[Clock] Cumulative uptime is: ")) + 
-        ct.timeIntervalSinceReferenceTime().toHumanReadableString() + 
-        " (" + String(ct.timeIntervalSinceReferenceTime().seconds()) + ")\n");
+    if (_isSyncing) {
+        pollSyncRound();
+        return !isIsolated();
+    }
+
+    const DeviceTime& localTime = _snapshot;
+    LOG_DEBUG(Clock, "Device time is: %T (%d)\n",
+        localTime.timeIntervalSinceReferenceTime(), localTime.timeIntervalSinceReferenceTime().seconds());
+    CumulativeTime ct = cumulativeTimeSnapshot();
+    LOG_DEBUG(Clock, "Cumulative uptime is: %T (%d)\n",
+        ct.timeIntervalSinceReferenceTime(), ct.timeIntervalSinceReferenceTime().seconds());
 
     if (_lastUptimeSaveTime == DeviceTime::distantPast() ||
         localTime.timeIntervalSince(_lastUptimeSaveTime) > kUptimeSaveInterval) {
         saveUptime();
     }
 
-    if (isIsolated() && 
-        (_lastSyncTrialTime != DeviceTime::distantPast() && 
-         localTime.timeIntervalSince(_lastSyncTrialTime) < kSyncRetryInterval)) {
-        LOG(F("[Clock] Not syncing (isolated): timeout hasn't passed since last failed trial\n"));
-        return false;
+    if (_lastSyncTrialTime != DeviceTime::distantPast() && 
+        localTime.timeIntervalSince(_lastSyncTrialTime) < kSyncRetryInterval) {
+        LOG_DEBUG(Clock, "Not syncing: timeout hasn't passed since last trial\n");
+        return !isIsolated();
     }
 
-    if (!isIsolated() && localTime.timeIntervalSince(_lastSuccessfulSyncTime) < kSyncInterval) {
-        LOG(F("[Clock] Not syncing (already synced): timeout hasn't passed since last successful sync\n"));
+    if (!isIsolated() && !_isResyncRequested &&
+        localTime.timeIntervalSince(_lastSuccessfulSyncTime) < _syncInterval) {
+        LOG_DEBUG(Clock, "Not syncing (already synced): timeout hasn't passed since last successful sync\n");
         return true;
     }
 
     _lastSyncTrialTime = localTime;
 
-    LOG(F("[Clock] Syncing network time..."));
-    
     if (WiFi.status() != WL_CONNECTED) {
-        LOG(F("failed: not connected\n"));
-        return false;
+        LOG_WARNING(Clock, "Not syncing: not connected\n");
+        return !isIsolated();
     }
 
-    // get a random server from the pool
-    IPAddress ntpServerIP;
-    if (!WiFi.hostByName(kNTPServerName, ntpServerIP)) {
-        LOG(F("failed: cannot resolve NTP host\n"));
-        return false;
+    beginSyncRound(localTime);
+
+    return !isIsolated();
+}
+
+TimeInterval ClockClass::timeIntervalTillNextSync() const {
+    if (_isSyncing) {
+        return kSyncRoundPollInterval;
     }
 
-    udp.begin(kLocalNTPPort);
+    if (_lastSyncTrialTime == DeviceTime::distantPast()) {
+        return TimeInterval::withSeconds(0);
+    }
 
-    sendNTPPacket(ntpServerIP);
+    DeviceTime dueTime = _lastSyncTrialTime + kSyncRetryInterval;
+    if (!isIsolated() && !_isResyncRequested && _lastSuccessfulSyncTime + _syncInterval > dueTime) {
+        dueTime = _lastSuccessfulSyncTime + _syncInterval;
+    }
 
-    // wait to see if a reply is available
-    int interval = 10;
-    int packetSize = 0;
-    while (packetSize == 0 && interval < 1000) {
-        delay(interval);
-        interval *= 2;
-        packetSize = udp.parsePacket();
+    DeviceTime uptimeSaveTime = _lastUptimeSaveTime + kUptimeSaveInterval;
+    if (uptimeSaveTime < dueTime) {
+        dueTime = uptimeSaveTime;
     }
 
-    DeviceTime syncTime = deviceTime();
+    return dueTime.timeIntervalSince(_snapshot);
+}
 
-    if (packetSize == 0) {
-        udp.stop();
-        LOG(F("failed: empty response\n"));
-        return false;
+static void dnsFoundCallback(const char* name, const ip_addr_t* ipaddr, void* arg) {
+    SNTPRequest* request = static_cast<SNTPRequest*>(arg);
+    if (request->state != kRequestResolving) {
+        // the round has ended in the meantime
+        return;
+    }
+
+    if (ipaddr) {
+        request->address = IPAddress(ipaddr->addr);
+        request->state = kRequestResolved;
+    }
+    else {
+        request->state = kRequestFailed;
+    }
+}
+
+// Queries every server of the pool at once. Host names are resolved
+// asynchronously, requests go out as soon as their host is resolved, and the
+// replies are collected by pollSyncRound() on subsequent loop iterations.
+void ClockClass::beginSyncRound(const DeviceTime& localTime) {
+    LOG_INFO(Clock, "Syncing network time...\n");
+
+    if (!isUDPOpen) {
+        udp.begin(kLocalNTPPort);
+        isUDPOpen = true;
+    }
+
+    // discard late replies to an earlier round
+    while (udp.parsePacket() > 0) {
+    }
+
+    for (int i = 0; i < kNumNTPServers; ++i) {
+        SNTPRequest& request = requests[i];
+        request.state = kRequestResolving;
+
+        char host[kMaxHostNameLength];
+        copyFromFlash(host, sizeof(host), flashStringAt(kNTPServerNames, i));
+
+        ip_addr_t address;
+        err_t err = dns_gethostbyname(host, &address, dnsFoundCallback, &request);
+        if (err == ERR_OK) {
+            request.address = IPAddress(address.addr);
+            request.state = kRequestResolved;
+        }
+        else if (err != ERR_INPROGRESS) {
+            LOG_WARNING(Clock, "%s: cannot resolve NTP host\n", flashStringAt(kNTPServerNames, i));
+            request.state = kRequestFailed;
+        }
+    }
+
+    _syncRoundDeadline = localTime + kSyncRoundTimeout;
+    _isSyncing = true;
+
+    pollSyncRound();
+}
+
+void ClockClass::pollSyncRound() {
+    for (int i = 0; i < kNumNTPServers; ++i) {
+        if (requests[i].state == kRequestResolved) {
+            sendRequest(i);
+        }
+    }
+
+    receiveReplies();
+
+    bool isPending = false;
+    for (int i = 0; i < kNumNTPServers; ++i) {
+        if (requests[i].state == kRequestResolving || requests[i].state == kRequestSent) {
+            isPending = true;
+        }
+    }
+
+    if (isPending && deviceTime() < _syncRoundDeadline) {
+        return;
+    }
+
+    endSyncRound();
+}
+
+void ClockClass::endSyncRound() {
+    // keep the sample with the shortest round trip, as that one has the
+    // smallest error bound
+    const SNTPRequest* best = nullptr;
+
+    for (int i = 0; i < kNumNTPServers; ++i) {
+        const SNTPRequest& request = requests[i];
+        if (request.state == kRequestAnswered && 
+            (!best || request.roundTripDelay < best->roundTripDelay)) {
+            best = &request;
+        }
+        else if (request.state != kRequestAnswered && request.state != kRequestFailed) {
+            LOG_WARNING(Clock, "%s: timed out\n", flashStringAt(kNTPServerNames, i));
+        }
     }
 
-    // We've received a packet, read the data from it
-    int bytesRead = udp.read(packetBuffer, kNTPPacketSize);
-    udp.stop();
-    
-    if (bytesRead != kNTPPacketSize) {
-        LOG(F("failed: unexpected NTP response\n"));
+    if (best) {
+        discipline(best->startupTime, best->receiveTime);
+    }
+    else {
+        LOG_ERROR(Clock, "Sync failed: no usable NTP response\n");
+    }
+
+    for (int i = 0; i < kNumNTPServers; ++i) {
+        requests[i].state = kRequestIdle;
+    }
+    _isSyncing = false;
+}
+
+void ClockClass::sendRequest(int index) {
+    SNTPRequest& request = requests[index];
+
+    request.transmitTime = deviceTime();
+    encodeNTPTimestamp(request.transmitTime, request.transmitTimestamp);
+    // the lowest fraction bits are below the clock resolution, use them to
+    // keep requests sent within the same tick apart
+    request.transmitTimestamp[kNTPTimestampSize - 1] = index + 1;
+
+    sendNTPPacket(request.address, request.transmitTimestamp);
+    request.state = kRequestSent;
+}
+
+static bool parseReply(SNTPRequest& request, const DeviceTime& receiveTime) {
+    if ((packetBuffer[0] & 0x7) != kNTPModeServer ||
+        (packetBuffer[0] >> 6) == kNTPLeapIndicatorUnsynchronized ||
+        packetBuffer[1] == 0 || packetBuffer[1] > 15) {
         return false;
     }
 
-    // the timestamp starts at byte 40 of the received packet and is four bytes
-    unsigned long highWord = word(packetBuffer[40], packetBuffer[41]);
-    unsigned long lowWord = word(packetBuffer[42], packetBuffer[43]);
-    // NTP time
-    unsigned long secondsSince1900 = (highWord << 16) | lowWord;
-    // unix timestamp
-    unsigned long currentTimestamp = secondsSince1900 - kUnixEpochStartSeconds;
-    uint32_t startupTimestamp = currentTimestamp - syncTime.timeIntervalSinceReferenceTime().seconds();
-    uint32_t firstStartupTimestamp = currentTimestamp - cumulativeTimeFromDeviceTime(syncTime).timeIntervalSinceReferenceTime().seconds();
+    // T1 and T4 are device times, T2 and T3 are network times, so the clock
+    // offset ((T2 - T1) + (T3 - T4)) / 2 is the network time at device startup
+    TimeInterval t1 = request.transmitTime.timeIntervalSinceReferenceTime();
+    TimeInterval t2 = timeIntervalFromNTPTimestamp(packetBuffer + kNTPReceiveTimestampOffset);
+    TimeInterval t3 = timeIntervalFromNTPTimestamp(packetBuffer + kNTPTransmitTimestampOffset);
+    TimeInterval t4 = receiveTime.timeIntervalSinceReferenceTime();
+
+    TimeInterval offset = (t2 - t1) + (t3 - t4);
+    request.startupTime = UnixTime(0) + TimeInterval::withTicks(offset._ticks / 2);
+    request.roundTripDelay = (t4 - t1) - (t3 - t2);
+    request.receiveTime = receiveTime;
 
-    _startupTime = UnixTime(startupTimestamp);
-    _firstStartupTime = UnixTime(firstStartupTimestamp);
+    return request.roundTripDelay <= kMaxRoundTripDelay;
+}
 
-    _lastSuccessfulSyncTime = syncTime;
-    
-    LOG(String(currentTimestamp) + "\n");
+void ClockClass::receiveReplies() {
+    while (udp.parsePacket() > 0) {
+        DeviceTime receiveTime = deviceTime();
+        int bytesRead = udp.read(packetBuffer, kNTPPacketSize);
+        if (bytesRead != kNTPPacketSize) {
+            LOG_WARNING(Clock, "unexpected NTP response\n");
+            continue;
+        }
 
-    return true;
+        // match the reply to its request by the echoed originate timestamp
+        int index = 0;
+        while (index < kNumNTPServers &&
+               (requests[index].state != kRequestSent ||
+                memcmp(packetBuffer + kNTPOriginateTimestampOffset, 
+                       requests[index].transmitTimestamp, kNTPTimestampSize) != 0)) {
+            ++index;
+        }
+
+        if (index == kNumNTPServers) {
+            LOG_WARNING(Clock, "unsolicited NTP response\n");
+            continue;
+        }
+
+        SNTPRequest& request = requests[index];
+        if (parseReply(request, receiveTime)) {
+            request.state = kRequestAnswered;
+            LOG_DEBUG(Clock, "%s: round trip %dms\n",
+                      flashStringAt(kNTPServerNames, index), request.roundTripDelay.milliseconds());
+        }
+        else {
+            request.state = kRequestFailed;
+            LOG_WARNING(Clock, "%s: unexpected NTP response\n", flashStringAt(kNTPServerNames, index));
+        }
+    }
+}
+
+void ClockClass::discipline(const UnixTime& startupTime, const DeviceTime& receiveTime) {
+    // after a deep sleep the residual is mostly the error of the RTC timer, which
+    // says nothing about the frequency of millis()
+    if (!isIsolated() && !_isResyncRequested) {
+        // the residual is the error of the current estimate extrapolated since the last sync
+        UnixTime predictedTime = unixTimeFromDeviceTime(receiveTime);
+        UnixTime measuredTime = startupTime + receiveTime.timeIntervalSinceReferenceTime();
+        TimeInterval residual = measuredTime.timeIntervalSince(predictedTime);
+        TimeInterval elapsed = receiveTime.timeIntervalSince(_lastSuccessfulSyncTime);
+        if (elapsed >= kMinSyncInterval) {
+            // clamped while still 64 bits wide, a large residual over a short interval
+            // would wrap when narrowed, and more than this is cut below anyway
+            int64_t residualPPM = residual._ticks * 1000000 / elapsed._ticks;
+            if (residualPPM > 2 * kMaxFrequencyErrorPPM) {
+                residualPPM = 2 * kMaxFrequencyErrorPPM;
+            }
+            else if (residualPPM < -2 * kMaxFrequencyErrorPPM) {
+                residualPPM = -2 * kMaxFrequencyErrorPPM;
+            }
+            _frequencyErrorPPM += int32_t(residualPPM) / 2;
+            if (_frequencyErrorPPM > kMaxFrequencyErrorPPM) {
+                _frequencyErrorPPM = kMaxFrequencyErrorPPM;
+            }
+            else if (_frequencyErrorPPM < -kMaxFrequencyErrorPPM) {
+                _frequencyErrorPPM = -kMaxFrequencyErrorPPM;
+            }
+        }
+
+        int64_t residualTicks = residual._ticks < 0 ? -residual._ticks : residual._ticks;
+        if (residualTicks < kResidualTolerance._ticks) {
+            _syncInterval += _syncInterval;
+            if (_syncInterval > kMaxSyncInterval) {
+                _syncInterval = kMaxSyncInterval;
+            }
+        }
+        else if (residualTicks > kResidualLimit._ticks) {
+            _syncInterval = TimeInterval::withTicks(_syncInterval._ticks / 2);
+            if (_syncInterval < kMinSyncInterval) {
+                _syncInterval = kMinSyncInterval;
+            }
+        }
+
+        LOG_INFO(Clock, "residual: %dms, frequency error: %dppm, next sync in %T\n",
+            residual.milliseconds(), _frequencyErrorPPM, _syncInterval);
+    }
+
+    _startupTime = startupTime;
+    _firstStartupTime = _startupTime - _previousUptime;
+    _lastSuccessfulSyncTime = receiveTime;
+    _isResyncRequested = false;
+
+    LOG_INFO(Clock, "Synced, network time is %u\n", unixTimeFromDeviceTime(receiveTime).seconds());
+}
+
+UnixTime ClockClass::unixTimeFromDeviceTime(const DeviceTime& dt) const {
+    if (isIsolated()) {
+        return UnixTime::distantPast();
+    }
+    const TimeInterval& interval = dt.timeIntervalSinceReferenceTime();
+    return _startupTime + interval + driftCorrection(interval);
 }
 
+UnixTime ClockClass::unixTimeFromCumulativeTime(const CumulativeTime& ct) const {
+    if (isIsolated()) {
+        return UnixTime::distantPast();
+    }
+    const TimeInterval& interval = ct.timeIntervalSinceReferenceTime();
+    // the drift was measured on millis() of this boot, earlier boots get the
+    // correction at its start rather than an extrapolation across them
+    TimeInterval sinceStartup = interval - _previousUptime;
+    if (sinceStartup < TimeInterval::withSeconds(0)) {
+        sinceStartup = TimeInterval::withSeconds(0);
+    }
+    return _firstStartupTime + interval + driftCorrection(sinceStartup);
+}
+
+// error accumulated by millis() since the last sync, for a device time given as
+// the interval since startup
+TimeInterval ClockClass::driftCorrection(const TimeInterval& sinceStartup) const {
+    if (_frequencyErrorPPM == 0) {
+        return TimeInterval::withSeconds(0);
+    }
+    TimeInterval elapsed = sinceStartup - _lastSuccessfulSyncTime.timeIntervalSinceReferenceTime();
+    return TimeInterval::withTicks(elapsed._ticks * _frequencyErrorPPM / 1000000);
+}
+
+// Advances the tick counter by the millis() elapsed since the previous call.
+// The 16.16 conversion multiplies by 65536 / 1000 in 16.16 fixed point instead
+// of dividing by 1000, and carries the truncated fraction over to the next call,
+// so the counter stays within 0.07 ppm of millis() and cannot lose ticks.
+// Unsigned subtraction handles the millis() wraparound.
 DeviceTime ClockClass::deviceTime() {
+    static const uint32_t kTicksPerMillisecond = 4294967;  // 65.536 in 16.16
+
     unsigned long ms = millis();
-    if (ms < _lastSeenSystemMillis) {
-        ++_systemMillisOverflow;
-    }
+    uint32_t elapsed = ms - _lastSeenSystemMillis;
     _lastSeenSystemMillis = ms;
-    return DeviceTime(ms, _systemMillisOverflow);
+
+    uint64_t scaledTicks = uint64_t(elapsed) * kTicksPerMillisecond + _deviceTicksResidue;
+    _deviceTicks += scaledTicks >> TimeInterval::kNumFractionBits;
+    _deviceTicksResidue = scaledTicks & TimeInterval::kFractionMask;
+
+    return DeviceTime::withTimeIntervalSinceReferenceTime(TimeInterval::withTicks(_deviceTicks));
 }
 
+#if DEBUG
+// Compares the per-call cost of building a DeviceTime by 64-bit division with
+// the incremental path and with the per-loop snapshot.
+void ClockClass::benchmark() {
+    static const int kIterations = 1000;
+    volatile int32_t sink = 0;
+
+    uint32_t startCycles = ESP.getCycleCount();
+    for (int i = 0; i < kIterations; ++i) {
+        sink += DeviceTime(millis()).seconds();
+    }
+    uint32_t divisionCycles = ESP.getCycleCount() - startCycles;
+
+    startCycles = ESP.getCycleCount();
+    for (int i = 0; i < kIterations; ++i) {
+        sink += deviceTime().seconds();
+    }
+    uint32_t incrementalCycles = ESP.getCycleCount() - startCycles;
+
+    startCycles = ESP.getCycleCount();
+    for (int i = 0; i < kIterations; ++i) {
+        sink += deviceTimeSnapshot().seconds();
+    }
+    uint32_t snapshotCycles = ESP.getCycleCount() - startCycles;
+
+    LOG_INFO(Clock, "deviceTime cost (cycles/call): division %u, incremental %u, snapshot %u\n",
+        divisionCycles / kIterations, incrementalCycles / kIterations, snapshotCycles / kIterations);
+}
+#endif
+
 void ClockClass::loadUptime() {
     uint32_t uptimeSeconds = 0;
     EEPROM.get(kEEPreviousUptimeSeconds, uptimeSeconds);
     _previousUptime = TimeInterval::withSeconds(uptimeSeconds);
-    LOG(String(F("[Clock] Loaded previous uptime: ")) + 
-        _previousUptime.toHumanReadableString() + 
-        " (" +
-        String(uptimeSeconds) +
-        ")\n");
+    LOG_INFO(Clock, "Loaded previous uptime: %T (%u)\n", _previousUptime, uptimeSeconds);
+
+    restoreAfterDeepSleep();
+}
+
+void ClockClass::saveForDeepSleep(const TimeInterval& duration) {
+    saveUptime();
+
+    ClockRTCState state;
+    state.magic = kRTCStateMagic;
+    state.frequencyErrorPPM = _frequencyErrorPPM;
+    state.syncIntervalSeconds = _syncInterval.seconds();
+    state.cumulativeTicks = (cumulativeTime().timeIntervalSinceReferenceTime() + duration)._ticks;
+    state.unixTicks = isIsolated() ? -1 : (unixTime().timeIntervalSinceReferenceTime() + duration)._ticks;
+    state.checksum = checksum(state);
+
+    ESP.rtcUserMemoryWrite(kRTCClockState, reinterpret_cast<uint32_t*>(&state), sizeof(state));
+}
+
+bool ClockClass::restoreAfterDeepSleep() {
+    ClockRTCState state;
+    if (!ESP.rtcUserMemoryRead(kRTCClockState, reinterpret_cast<uint32_t*>(&state), sizeof(state)) ||
+        state.magic != kRTCStateMagic) {
+        return false;
+    }
+
+    // the state is only good for the wake-up it was saved for
+    uint32_t cleared = 0;
+    ESP.rtcUserMemoryWrite(kRTCClockState, &cleared, sizeof(cleared));
+
+    if (state.checksum != checksum(state) || system_get_rst_info()->reason != REASON_DEEP_SLEEP_AWAKE) {
+        return false;
+    }
+
+    TimeInterval sinceStartup = deviceTime().timeIntervalSinceReferenceTime();
+    _previousUptime = TimeInterval::withTicks(state.cumulativeTicks) - sinceStartup;
+    _frequencyErrorPPM = state.frequencyErrorPPM;
+    _syncInterval = TimeInterval::withSeconds(state.syncIntervalSeconds);
+
+    if (state.unixTicks != -1) {
+        _startupTime = UnixTime(0) + TimeInterval::withTicks(state.unixTicks) - sinceStartup;
+        _firstStartupTime = _startupTime - _previousUptime;
+        // millis() restarted, so its drift is measured from now on
+        _lastSuccessfulSyncTime = deviceTime();
+        _isResyncRequested = true;
+    }
+
+    LOG_INFO(Clock, "Restored clock after deep sleep, cumulative uptime: %T\n",
+        TimeInterval::withTicks(state.cumulativeTicks));
+
+    return true;
 }
 
 void ClockClass::saveUptime() {
     DeviceTime localTime = deviceTime();
     uint32_t uptimeSeconds = _previousUptime.seconds() + localTime.timeIntervalSinceReferenceTime().seconds();
-    EEPROM.put(kEEPreviousUptimeSeconds, uptimeSeconds);
+    Persistence.put(PersistenceClass::kSubsystemClock, kEEPreviousUptimeSeconds, uptimeSeconds);
     _lastUptimeSaveTime = localTime;
-    LOG(String(F("[Clock] Saved current uptime (")) + 
-        TimeInterval::withSeconds(uptimeSeconds).toHumanReadableString() +
-        ")\n");
+    LOG_DEBUG(Clock, "Saved current uptime (%T)\n", TimeInterval::withSeconds(uptimeSeconds));
 }
@@ -1,6 +1,7 @@
 #ifndef __clock_h
 #define __clock_h
 
+#include "common.h"
 #include "time.h"
 
 class ClockClass {
@@ -9,35 +10,31 @@ public:
 
     bool isIsolated() const { return _startupTime == UnixTime::distantPast(); }
     bool sync();
+    // time till sync() has work to do, relative to the snapshot
+    TimeInterval timeIntervalTillNextSync() const;
 
     void loadUptime();
     void saveUptime();
 
+    // Carries the clock over a deep sleep of the given duration in RTC memory.
+    // Cumulative and network time continue from where they would be at wake-up,
+    // and the next sync is brought forward to correct the error of the RTC timer.
+    void saveForDeepSleep(const TimeInterval& duration);
+
     DeviceTime deviceTime();
 
-    UnixTime unixTime() {
-        if (isIsolated()) {
-            return UnixTime::distantPast();
-        }
-        TimeInterval interval = deviceTime().timeIntervalSinceReferenceTime();
-        return _startupTime + interval;
-    }
+    // a reading shared by everything that runs in the same loop iteration
+    void takeSnapshot() { _snapshot = deviceTime(); }
+    const DeviceTime& deviceTimeSnapshot() const { return _snapshot; }
+    CumulativeTime cumulativeTimeSnapshot() const { return CumulativeTime(_snapshot, _previousUptime); }
 
-    UnixTime unixTimeFromDeviceTime(const DeviceTime& dt) {
-        if (isIsolated()) {
-            return UnixTime::distantPast();
-        }
-        TimeInterval interval = dt.timeIntervalSinceReferenceTime();
-        return _startupTime + interval;
-    }
+#if DEBUG
+    void benchmark();
+#endif
 
-    UnixTime unixTimeFromCumulativeTime(const CumulativeTime& ct) {
-        if (isIsolated()) {
-            return UnixTime::distantPast();
-        }
-        TimeInterval interval = ct.timeIntervalSinceReferenceTime();
-        return _firstStartupTime + interval;
-    }
+    UnixTime unixTime() { return unixTimeFromDeviceTime(deviceTime()); }
+    UnixTime unixTimeFromDeviceTime(const DeviceTime& dt) const;
+    UnixTime unixTimeFromCumulativeTime(const CumulativeTime& ct) const;
 
     CumulativeTime cumulativeTime() {
         return CumulativeTime(deviceTime(), _previousUptime);
@@ -47,15 +44,37 @@ public:
         return CumulativeTime(dt, _previousUptime);
     }
 
+    // estimated frequency error of millis() relative to network time
+    int32_t frequencyErrorPPM() const { return _frequencyErrorPPM; }
+    const TimeInterval& syncInterval() const { return _syncInterval; }
+
+private:
+    void beginSyncRound(const DeviceTime& localTime);
+    void pollSyncRound();
+    void endSyncRound();
+    void sendRequest(int index);
+    void receiveReplies();
+    void discipline(const UnixTime& startupTime, const DeviceTime& receiveTime);
+    TimeInterval driftCorrection(const TimeInterval& sinceStartup) const;
+    bool restoreAfterDeepSleep();
+
 private:
     DeviceTime _lastSuccessfulSyncTime;
     DeviceTime _lastSyncTrialTime;
     DeviceTime _lastUptimeSaveTime;
+    DeviceTime _syncRoundDeadline;
+    bool _isSyncing;
+    // set after a deep sleep, the next sync is due right away
+    bool _isResyncRequested;
     UnixTime _startupTime;
     UnixTime _firstStartupTime;
     TimeInterval _previousUptime;
+    TimeInterval _syncInterval;
+    int32_t _frequencyErrorPPM;
 
-    uint16_t _systemMillisOverflow;
+    DeviceTime _snapshot;
+    int64_t _deviceTicks;
+    uint32_t _deviceTicksResidue;
     unsigned long _lastSeenSystemMillis;
 };
 
@@ -1,6 +1,6 @@
 #include "common.h"
 
-const uint16_t kFirmwareVersion = 1;
+const uint16_t kFirmwareVersion = 2;
 
 const uint8_t pinD[] = {16, 5, 4, 0, 2, 14, 12, 13, 15};
 const uint8_t pinA[] = {17};
@@ -5,6 +5,9 @@
 
 extern const uint16_t kFirmwareVersion;
 
+// version of the EEPROM layout below, independent of the firmware version
+static const uint16_t kSchemaVersion = 5;
+
 // NodeMCU pin mapping
 extern const uint8_t pinD[];
 extern const uint8_t pinA[];
@@ -46,25 +49,44 @@ typedef uint16_t Seconds;
 
 
 
+// The layout is listed once and expanded both into the offset enum below and
+// into the cell descriptor table of the EEPROM schema (see eeprom_schema.h).
+// Bump kSchemaVersion and add a migration step when changing it.
+#define EEPROM_LAYOUT(__cell_type__, __cell_size__) \
+    __cell_type__(kEESchemaVersion, uint16_t) \
+    __cell_type__(kEELastDutyCycleCumulativeTimeSeconds, uint32_t) \
+    __cell_type__(kEELastDutyCycleUnixTimeSeconds, uint32_t) \
+    __cell_type__(kEEPreviousUptimeSeconds, uint32_t) \
+    __cell_size__(kEETasks, kNumOutputValves * 22) \
+    __cell_type__(kEEDutyCycleIntervalSeconds, uint32_t) \
+    __cell_size__(kEEWiFiCache, 28) \
+    __cell_size__(kEEFlowTotals, kNumOutputValves * 4) \
+    __cell_type__(kEEChecksum, uint32_t)
+
 EEPROM_LAYOUT_BEGIN
 
-EEPROM_CELL_TYPE(kEEFirmwareVersion, uint16_t)
-EEPROM_CELL_TYPE(kEELastDutyCycleCumulativeTimeSeconds, uint32_t)
-EEPROM_CELL_TYPE(kEELastDutyCycleUnixTimeSeconds, uint32_t)
-EEPROM_CELL_TYPE(kEEPreviousUptimeSeconds, uint32_t)
-EEPROM_CELL_SIZE(kEETasks, kNumOutputValves * 20)
-EEPROM_CELL_TYPE(kEEDutyCycleIntervalSeconds, uint32_t)
+EEPROM_LAYOUT(EEPROM_CELL_TYPE, EEPROM_CELL_SIZE)
 
 EEPROM_LAYOUT_END
 
 
+// RTC user memory, in 4 byte blocks. It survives resets, but not power loss.
+// The first 32 blocks are left alone, eboot keeps its OTA command there.
+enum RTCMemoryOffsets {
+    kRTCWatchdogSnapshot = 32,
+    kRTCClockState = 40,
+    kRTCEnd = 48
+};
+
+static_assert(kRTCEnd <= 128, "RTC user memory is 512 bytes");
+
+// Host names are kept in flash and copied to the stack for the resolver, which
+// cannot read flash. This fits every host the firmware talks to, with the terminator.
+static const int kMaxHostNameLength = 32;
+
+
 #define DEBUG 1
 
-#if DEBUG
-#include <HardwareSerial.h>
-#define LOG(...) Serial.print(__VA_ARGS__)
-#else
-#define LOG(...)
-#endif
+#include "logger.h"
 
 #endif // __common_h
@@ -4,31 +4,39 @@
 #include "clock.h"
 #include "common.h"
 #include "http_response.h"
+#include "profiler.h"
+#include "scheduler.h"
 #include "string_ext.h"
 
-static const char kNoIPUsername[] = "*";
-static const char kNoIPPassword[] = "*";
-static const char kNoIPHostname[] = "*";
+static const char kNoIPUsername[] PROGMEM = "*";
+static const char kNoIPPassword[] PROGMEM = "*";
+static const char kNoIPHostname[] PROGMEM = "*";
 
-static const TimeInterval kUpdateInterval = TimeInterval::withSeconds(60 * 15);
+static constexpr TimeInterval kUpdateInterval = 15_min;
+static constexpr TimeInterval kRetryInterval = 1_min;
 
 
 DDNSClass DDNS;
 
 DDNSClass::DDNSClass():
     _wasOffline(true),
-    _lastUpdateCumulativeTime(CumulativeTime::distantPast()) {
+    _lastUpdateCumulativeTime(CumulativeTime::distantPast()),
+    _lastTrialCumulativeTime(CumulativeTime::distantPast()) {
 }
 
 bool DDNSClass::getExternalIPAddress(String& address) {
     if (WiFi.status() != WL_CONNECTED) {
-        LOG(F("[ipify] failed: not connected\n"));
+        LOG_WARNING(DDNS, "ipify: failed: not connected\n");
         return false;
     }
 
+    ProfilerScope scope(kProbeCallIpify);
+
     IPAddress serverIP;
-    if (!WiFi.hostByName("api.ipify.org", serverIP)) {
-        LOG(F("[ipify] error: cannot resolve IPify server host\n"));
+    char host[kMaxHostNameLength];
+    copyFromFlash(host, sizeof(host), F("api.ipify.org"));
+    if (!WiFi.hostByName(host, serverIP)) {
+        LOG_ERROR(DDNS, "ipify: cannot resolve IPify server host\n");
         return false;
     }
 
@@ -41,7 +49,7 @@ bool DDNSClass::getExternalIPAddress(String& address) {
     }
 
     if (!client.connected()) {
-        LOG(F("[ipify] error: cannot connect to IPify server\n"));
+        LOG_ERROR(DDNS, "ipify: cannot connect to IPify server\n");
         return false;
     }
 
@@ -56,43 +64,75 @@ bool DDNSClass::getExternalIPAddress(String& address) {
     }
 
     if (!client.available()) {
-        LOG(F("[ipify] error: connection reset\n"));
+        LOG_ERROR(DDNS, "ipify: connection reset\n");
         return false;
     }
 
     HTTPResponse response(client, true);
     if (response.statusCode() != 200) {
-        LOG(String(F("[ipify] error: server returned ")) + String(response.statusCode()) + F("\n"));
+        LOG_ERROR(DDNS, "ipify: server returned %d\n", response.statusCode());
         return false;
     }
 
     address = response.body();
     client.stop();
 
-    LOG(String(F("[ipify] external IP: [")) + address + F("]\n"));
+    LOG_INFO(DDNS, "ipify: external IP: [%s]\n", address);
 
     return true;
 }
 
+TimeInterval DDNSClass::timeIntervalTillNextUpdate() const {
+    CumulativeTime now = Clock.cumulativeTimeSnapshot();
+    CumulativeTime dueTime = SchedulerClass::nextSlot(_lastUpdateCumulativeTime, kUpdateInterval);
+
+    if (_wasOffline) {
+        // getting connected wakes the loop by itself
+        if (WiFi.status() != WL_CONNECTED) {
+            return SchedulerClass::noDeadline();
+        }
+        dueTime = now;
+    }
+
+    if (_lastTrialCumulativeTime != CumulativeTime::distantPast() &&
+        _lastTrialCumulativeTime + kRetryInterval > dueTime) {
+        dueTime = _lastTrialCumulativeTime + kRetryInterval;
+    }
+
+    return dueTime.timeIntervalSince(now);
+}
+
 bool DDNSClass::updateDDNS() {
-    DeviceTime localTime = Clock.deviceTime();
-    CumulativeTime dueTime = _lastUpdateCumulativeTime + kUpdateInterval;
+    const DeviceTime& localTime = Clock.deviceTimeSnapshot();
+    CumulativeTime dueTime = SchedulerClass::nextSlot(_lastUpdateCumulativeTime, kUpdateInterval);
     int32_t seconds = dueTime.timeIntervalSince(Clock.cumulativeTimeFromDeviceTime(localTime)).seconds();
 
     if (seconds > 0 && !_wasOffline) {
-        LOG(F("[noip] not updating.\n"));
+        LOG_DEBUG(DDNS, "noip: not updating.\n");
         return false;
     }
 
     if (WiFi.status() != WL_CONNECTED) {
-        LOG(F("[noip] failed: not connected\n"));
+        LOG_WARNING(DDNS, "noip: failed: not connected\n");
         _wasOffline = true;
         return false;
     }
 
+    CumulativeTime now = Clock.cumulativeTimeFromDeviceTime(localTime);
+    if (_lastTrialCumulativeTime != CumulativeTime::distantPast() &&
+        now.timeIntervalSince(_lastTrialCumulativeTime) < kRetryInterval) {
+        LOG_DEBUG(DDNS, "noip: not retrying yet.\n");
+        return false;
+    }
+    _lastTrialCumulativeTime = now;
+
+    ProfilerScope scope(kProbeCallNoIP);
+
     IPAddress serverIP;
-    if (!WiFi.hostByName("dynupdate.no-ip.com", serverIP)) {
-        LOG(F("[noip] error: cannot resolve No-IP server host\n"));
+    char host[kMaxHostNameLength];
+    copyFromFlash(host, sizeof(host), F("dynupdate.no-ip.com"));
+    if (!WiFi.hostByName(host, serverIP)) {
+        LOG_ERROR(DDNS, "noip: cannot resolve No-IP server host\n");
         return false;
     }
 
@@ -105,15 +145,18 @@ bool DDNSClass::updateDDNS() {
     }
 
     if (!client.connected()) {
-        LOG(F("[noip] error: cannot connect to No-IP server\n"));
+        LOG_ERROR(DDNS, "noip: cannot connect to No-IP server\n");
         return false;
     }
 
     String credentials;
-    base64Encode(String(kNoIPUsername) + ":" + kNoIPPassword, credentials);
+    String account(FPSTR(kNoIPUsername));
+    account += ':';
+    account += FPSTR(kNoIPPassword);
+    base64Encode(account, credentials);
 
     String request(F("GET /nic/update?hostname="));
-    request += kNoIPHostname;
+    request += FPSTR(kNoIPHostname);
     request += F(" HTTP/1.1\r\n");
     request += F("Host: dynupdate.no-ip.com\r\n");
     request += F("User-Agent: Irrigator/1.0 maintainer@domain.com\r\n");
@@ -130,24 +173,24 @@ bool DDNSClass::updateDDNS() {
     }
 
     if (!client.available()) {
-        LOG(F("[noip] error: connection reset\n"));
+        LOG_ERROR(DDNS, "noip: connection reset\n");
         return false;
     }
 
     HTTPResponse response(client, true);
     if (response.statusCode() != 200) {
-        LOG(String(F("[noip] error: server returned ")) + String(response.statusCode()) + F("\n"));
+        LOG_ERROR(DDNS, "noip: server returned %d\n", response.statusCode());
         return false;
     }
 
     client.stop();
 
-    if (response.body().indexOf("nochg") == -1 && response.body().indexOf("good") == -1) {
-        LOG(String(F("[noip] error: DDNS update failed [")) + response.body() + F("]\n"));
+    if (!containsFlash(response.body().c_str(), F("nochg")) && !containsFlash(response.body().c_str(), F("good"))) {
+        LOG_ERROR(DDNS, "noip: DDNS update failed [%s]\n", response.body());
         return false;
     }
 
-    LOG(F("[noip] DDNS updated successfully.\n"));
+    LOG_INFO(DDNS, "noip: DDNS updated successfully.\n");
     _lastUpdateCumulativeTime = Clock.cumulativeTimeFromDeviceTime(localTime);
     _wasOffline = false;
 
@@ -8,9 +8,11 @@ public:
     DDNSClass();
     bool getExternalIPAddress(String& address);
     bool updateDDNS();
+    TimeInterval timeIntervalTillNextUpdate() const;
 
 private:
     CumulativeTime _lastUpdateCumulativeTime;
+    CumulativeTime _lastTrialCumulativeTime;
     bool _wasOffline;
 };
 
@@ -3,13 +3,18 @@
 #include <EEPROM.h>
 #include "clock.h"
 #include "irrigator.h"
+#include "persistence.h"
+#include "watchdog.h"
 
 #if DEBUG
-static const TimeInterval kDutyCycleInterval = TimeInterval::withSeconds(60);
+static constexpr TimeInterval kDutyCycleInterval = 1_min;
 #else
-static const TimeInterval kDutyCycleInterval = TimeInterval::withSeconds(60 * 60 * 24);
+static constexpr TimeInterval kDutyCycleInterval = 24_h;
 #endif
 
+// on top of the task duration, covers the valve transients
+static constexpr TimeInterval kTaskWatchdogMargin = 10_s;
+
 DutyCycleManagerClass DutyCycleManager;
 
 DutyCycleManagerClass::DutyCycleManagerClass():
@@ -17,24 +22,21 @@ DutyCycleManagerClass::DutyCycleManagerClass():
     _lastCycleUnixTime(UnixTime::distantPast()),
     _isScheduled(false),
     _scheduledCumulativeTime(CumulativeTime::distantPast()),
-    _cycleInterval(kDutyCycleInterval) {
+    _cycleInterval(kDutyCycleInterval),
+    _generation(1) {
 }
 
 void DutyCycleManagerClass::loadState() {
-    LOG(F("[DutyCycleManager] Last cycle run time (stored):\n"));
+    LOG_INFO(DutyCycleManager, "Last cycle run time (stored):\n");
 
     uint32_t seconds = 0;
     EEPROM.get(kEELastDutyCycleCumulativeTimeSeconds, seconds);
     _lastCycleCumulativeTime = CumulativeTime(Clock.deviceTime(), TimeInterval::withSeconds(seconds));
-    LOG(String(F("[DutyCycleManager]  - cumulative uptime: ")) + 
-        _lastCycleCumulativeTime.timeIntervalSinceReferenceTime().toHumanReadableString() + 
-        "\n");
+    LOG_INFO(DutyCycleManager, " - cumulative uptime: %T\n", _lastCycleCumulativeTime.timeIntervalSinceReferenceTime());
 
     EEPROM.get(kEELastDutyCycleUnixTimeSeconds, seconds);
     _lastCycleUnixTime = UnixTime(seconds);
-    LOG(String(F("[DutyCycleManager]  - network time: ")) + 
-        String(_lastCycleUnixTime.timeIntervalSinceReferenceTime().seconds()) + 
-        "\n");
+    LOG_INFO(DutyCycleManager, " - network time: %d\n", _lastCycleUnixTime.timeIntervalSinceReferenceTime().seconds());
 
     loadTasks();
 
@@ -42,21 +44,23 @@ void DutyCycleManagerClass::loadState() {
     if (seconds >= 60) {
         _cycleInterval = TimeInterval::withSeconds(seconds);
     }
+
+    ++_generation;
 }
 
 bool DutyCycleManagerClass::isDue() const {
     int32_t seconds = timeIntervalTillNextCycle().seconds();
-    LOG(String(F("[DutyCycleManager] next cycle should begin in ")) + String(seconds) + " sec\n");
+    LOG_DEBUG(DutyCycleManager, "next cycle should begin in %d sec\n", seconds);
     return seconds <= 0;
 }
 
 TimeInterval DutyCycleManagerClass::timeIntervalSinceLastCycle() const {
-    CumulativeTime now = Clock.cumulativeTime();
+    CumulativeTime now = Clock.cumulativeTimeSnapshot();
     return now.timeIntervalSince(_lastCycleCumulativeTime);
 }
 
 TimeInterval DutyCycleManagerClass::timeIntervalTillNextCycle() const {
-    DeviceTime localTime = Clock.deviceTime();
+    const DeviceTime& localTime = Clock.deviceTimeSnapshot();
     if (_isScheduled) {
         return _scheduledCumulativeTime.timeIntervalSince(Clock.cumulativeTimeFromDeviceTime(localTime));
     }
@@ -76,7 +80,7 @@ TimeInterval DutyCycleManagerClass::timeIntervalTillNextCycle() const {
 }
 
 void DutyCycleManagerClass::run() {
-    LOG(F("[DutyCycleManager] Starting duty cycle.\n"));
+    LOG_INFO(DutyCycleManager, "Starting duty cycle.\n");
     DeviceTime cycleRunTime = Clock.deviceTime();
 
     for (int i = 0; i < kNumOutputValves; ++i) {
@@ -85,48 +89,61 @@ void DutyCycleManagerClass::run() {
             IrrigatorClass::Task t;
             t.valve = task.valve;
             t.duration = task.duration;
+            t.volumeDecilitres = task.volumeDecilitres;
+
+            Watchdog.arm(kWatchdogDutyCycle, TimeInterval::withSeconds(task.duration) + kTaskWatchdogMargin);
             Irrigator.performTask(t);
         } 
         else {
-            LOG(String(F("[DutyCycleManager] skipping task for valve ")) + String(task.valve) + String(F(": disabled\n")));
+            LOG_INFO(DutyCycleManager, "skipping task for valve %u: disabled\n", task.valve);
         }
     }
 
+    Irrigator.waitUntilIdle();
+    Watchdog.disarm(kWatchdogDutyCycle);
+
     _lastCycleCumulativeTime = Clock.cumulativeTimeFromDeviceTime(cycleRunTime);
     uint32_t seconds = _lastCycleCumulativeTime.timeIntervalSinceReferenceTime().seconds();
-    EEPROM.put(kEELastDutyCycleCumulativeTimeSeconds, seconds);
+    Persistence.put(PersistenceClass::kSubsystemDutyCycleManager, kEELastDutyCycleCumulativeTimeSeconds, seconds);
 
     Clock.saveUptime();
 
     if (!Clock.isIsolated()) {
         _lastCycleUnixTime = Clock.unixTimeFromDeviceTime(cycleRunTime);
-        seconds = _lastCycleUnixTime.timeIntervalSinceReferenceTime().seconds();
-        EEPROM.put(kEELastDutyCycleUnixTimeSeconds, seconds);
     }
 
-    LOG(F("[DutyCycleManager] Duty cycle finished.\n"));
+    // the cycle record must survive a reset, so commit it together with the above
+    seconds = _lastCycleUnixTime.timeIntervalSinceReferenceTime().seconds();
+    Persistence.put(PersistenceClass::kSubsystemDutyCycleManager, kEELastDutyCycleUnixTimeSeconds, seconds,
+                    PersistenceClass::kCritical);
+
+    LOG_INFO(DutyCycleManager, "Duty cycle finished.\n");
 
     _isScheduled = false;
+    ++_generation;
 }
 
 void DutyCycleManagerClass::reset() {
     _lastCycleCumulativeTime = Clock.cumulativeTime();
     uint32_t seconds = _lastCycleCumulativeTime.timeIntervalSinceReferenceTime().seconds();
-    EEPROM.put(kEELastDutyCycleCumulativeTimeSeconds, seconds);
+    Persistence.put(PersistenceClass::kSubsystemDutyCycleManager, kEELastDutyCycleCumulativeTimeSeconds, seconds);
 
     Clock.saveUptime();
 
     _lastCycleUnixTime = Clock.unixTimeFromCumulativeTime(_lastCycleCumulativeTime);
     seconds = _lastCycleUnixTime.timeIntervalSinceReferenceTime().seconds();
-    EEPROM.put(kEELastDutyCycleUnixTimeSeconds, _lastCycleUnixTime);
+    Persistence.put(PersistenceClass::kSubsystemDutyCycleManager, kEELastDutyCycleUnixTimeSeconds, seconds,
+                    PersistenceClass::kCritical);
 
     _isScheduled = false;
+    ++_generation;
 }
 
 void DutyCycleManagerClass::schedule(const TimeInterval& ti) {
     DeviceTime scheduledTime = Clock.deviceTime() + ti;
     _scheduledCumulativeTime = Clock.cumulativeTimeFromDeviceTime(scheduledTime);
     _isScheduled = true;
+    ++_generation;
 }
 
 void DutyCycleManagerClass::setCycleInterval(const TimeInterval& ti) {
@@ -135,12 +152,16 @@ void DutyCycleManagerClass::setCycleInterval(const TimeInterval& ti) {
     }
 
     _cycleInterval = ti;
-    EEPROM.put(kEEDutyCycleIntervalSeconds, _cycleInterval.seconds());
+    uint32_t seconds = _cycleInterval.seconds();
+    Persistence.put(PersistenceClass::kSubsystemDutyCycleManager, kEEDutyCycleIntervalSeconds, seconds,
+                    PersistenceClass::kCritical);
+    ++_generation;
 }
 
 void DutyCycleManagerClass::updateTask(const Task& task) {
     _tasks[task.valve] = task;
-    saveTasks();
+    saveTask(task.valve);
+    ++_generation;
 }
 
 void DutyCycleManagerClass::loadTasks() {
@@ -149,19 +170,15 @@ void DutyCycleManagerClass::loadTasks() {
     for (int i = 0; i < kNumOutputValves; ++i) {
         EEPROM.get(addr, _tasks[i]);
         _tasks[i].valve = outputValves[i];
-        LOG(String("loaded task for valve ") + String(outputValves[i]) + ": " +
-            TimeInterval::withSeconds(_tasks[i].duration).toHumanReadableString() + "\n");
+        LOG_INFO(DutyCycleManager, "loaded task for valve %u: %T\n",
+            outputValves[i], TimeInterval::withSeconds(_tasks[i].duration));
         addr += sizeof(Task);
     }
 }
 
-void DutyCycleManagerClass::saveTasks() {
-    int addr = kEETasks;
-
-    for (int i = 0; i < kNumOutputValves; ++i) {
-        LOG(String("saving task for valve ") + String(outputValves[i]) + ": " + 
-            TimeInterval::withSeconds(_tasks[i].duration).toHumanReadableString());
-        EEPROM.put(addr, _tasks[i]);
-        addr += sizeof(Task);
-    }
+void DutyCycleManagerClass::saveTask(int index) {
+    LOG_INFO(DutyCycleManager, "saving task for valve %u: %T\n",
+        outputValves[index], TimeInterval::withSeconds(_tasks[index].duration));
+    Persistence.put(PersistenceClass::kSubsystemDutyCycleManager, kEETasks + index * sizeof(Task), _tasks[index],
+                    PersistenceClass::kCritical);
 }
@@ -14,6 +14,8 @@ public:
         bool isEnabled;
         Seconds duration;
         char description[kDescriptionMaxLength + 1];
+        // stops the task once delivered if a flow meter is installed, 0 for time based tasks
+        uint16_t volumeDecilitres;
     };
 #pragma pack(pop)
 
@@ -35,9 +37,13 @@ public:
     void schedule(const TimeInterval& ti);
     void setCycleInterval(const TimeInterval& ti);
 
+    // Counts the changes to the tasks, the interval and the cycle record, so
+    // that what is rendered from them can be cached until the next one.
+    uint32_t generation() const { return _generation; }
+
 private:
     void loadTasks();
-    void saveTasks();
+    void saveTask(int index);
 
 private:
     Task _tasks[kNumOutputValves];
@@ -46,6 +52,7 @@ private:
     bool _isScheduled;
     CumulativeTime _scheduledCumulativeTime;
     TimeInterval _cycleInterval;
+    uint32_t _generation;
 };
 
 extern DutyCycleManagerClass DutyCycleManager;
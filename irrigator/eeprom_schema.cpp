@@ -0,0 +1,283 @@
+#include "eeprom_schema.h"
+
+#include <EEPROM.h>
+#include <spi_flash.h>
+#include <string.h>
+#include "duty_cycle_manager.h"
+#include "wifi_connection.h"
+
+#define EEPROM_CELL_NAME(__alias__, __type_or_size__) \
+    static const char __alias__##Name[] PROGMEM = #__alias__;
+
+#define EEPROM_CELL_TYPE_DESCRIPTOR(__alias__, __type__) \
+    { __alias__##Name, __alias__, sizeof(__type__) },
+
+#define EEPROM_CELL_SIZE_DESCRIPTOR(__alias__, __size__) \
+    { __alias__##Name, __alias__, (__size__) },
+
+EEPROM_LAYOUT(EEPROM_CELL_NAME, EEPROM_CELL_NAME)
+
+static const EEPROMCellDescriptor kCells[] PROGMEM = {
+    EEPROM_LAYOUT(EEPROM_CELL_TYPE_DESCRIPTOR, EEPROM_CELL_SIZE_DESCRIPTOR)
+};
+
+// The steps work on the layout of the versions they convert between, so they use
+// the offsets of those versions, not the cells of the current layout.
+
+// v2 appended the checksum cell, which is filled in when the image is sealed
+static bool migrateFrom1To2(uint8_t* image) {
+    return true;
+}
+
+// v3 inserted the WiFi cache before the checksum, the old checksum is cleared with it
+static bool migrateFrom2To3(uint8_t* image) {
+    static const int kWiFiCache = 98;
+    static const int kWiFiCacheSize = 24;
+
+    memset(image + kWiFiCache, 0, kWiFiCacheSize);
+    return true;
+}
+
+// v4 appended a volume to each task and added the flow totals before the checksum
+static bool migrateFrom3To4(uint8_t* image) {
+    static const int kTasks = 14;
+    static const int kOldTaskSize = 20;
+    static const int kNewTaskSize = 22;
+    static const int kTasksGrowth = kNumOutputValves * (kNewTaskSize - kOldTaskSize);
+    // the duty cycle interval and the WiFi cache, in v3
+    static const int kOldBlock = kTasks + kNumOutputValves * kOldTaskSize;
+    static const int kBlockSize = 4 + 24;
+    static const int kFlowTotals = kOldBlock + kTasksGrowth + kBlockSize;
+    static const int kFlowTotalsSize = kNumOutputValves * 4;
+
+    // the duty cycle interval and the WiFi cache move up as a block
+    memmove(image + kOldBlock + kTasksGrowth, image + kOldBlock, kBlockSize);
+
+    // from the last task down, so that no task is overwritten before it has moved
+    for (int i = kNumOutputValves - 1; i >= 0; --i) {
+        uint8_t* task = image + kTasks + i * kNewTaskSize;
+        memmove(task, image + kTasks + i * kOldTaskSize, kOldTaskSize);
+        memset(task + kOldTaskSize, 0, kNewTaskSize - kOldTaskSize);
+    }
+
+    memset(image + kFlowTotals, 0, kFlowTotalsSize);
+    return true;
+}
+
+// v5 added the lease renewal time to the WiFi cache, which is cleared, and the flow totals moved up
+static bool migrateFrom4To5(uint8_t* image) {
+    static const int kWiFiCache = 106;
+    static const int kOldWiFiCacheSize = 24;
+    static const int kNewWiFiCacheSize = 28;
+    static const int kFlowTotalsSize = kNumOutputValves * 4;
+
+    memmove(image + kWiFiCache + kNewWiFiCacheSize, image + kWiFiCache + kOldWiFiCacheSize, kFlowTotalsSize);
+    memset(image + kWiFiCache, 0, kNewWiFiCacheSize);
+    return true;
+}
+
+// kMigrationSteps[i] upgrades schema version i + 1 to i + 2
+static const EEPROMSchemaClass::MigrationStep kMigrationSteps[] = {
+    migrateFrom1To2,
+    migrateFrom2To3,
+    migrateFrom3To4,
+    migrateFrom4To5,
+};
+
+static_assert(kEESchemaVersion == 0,
+              "the schema version must stay at offset 0 so that any stored image can be identified");
+static_assert(kEEChecksum == kEESize - sizeof(uint32_t),
+              "the checksum must be the last cell");
+static_assert(kEETasks_END - kEETasks + 1 == kNumOutputValves * sizeof(DutyCycleManagerClass::Task),
+              "kEETasks must hold exactly one Task record per output valve");
+static_assert(kEEWiFiCache_END - kEEWiFiCache + 1 == sizeof(WiFiConnectionClass::Cache),
+              "kEEWiFiCache must hold exactly one WiFi cache record");
+static_assert(kEEFlowTotals_END - kEEFlowTotals + 1 == kNumOutputValves * sizeof(uint32_t),
+              "kEEFlowTotals must hold exactly one total per output valve");
+static_assert(kEESize <= SPI_FLASH_SEC_SIZE,
+              "the image must fit in a single flash sector");
+static_assert(sizeof(kMigrationSteps) / sizeof(kMigrationSteps[0]) == kSchemaVersion - 1,
+              "every schema version needs a migration step from its predecessor");
+
+// The shadow copy lives in the flash sector right below the EEPROM sector, i.e. the
+// last sector of the SPIFFS area, which this firmware never mounts. That sector
+// only exists with a flash layout that reserves a filesystem, e.g. "4MB (FS:1MB)"
+// for the NodeMCU; without one it belongs to the sketch and OTA area, so the
+// shadow is disabled and commits are no longer protected against resets.
+extern "C" uint32_t _SPIFFS_start;
+extern "C" uint32_t _SPIFFS_end;
+static EEPROMClass ShadowEEPROM((((uintptr_t)&_SPIFFS_end - 0x40200000) / SPI_FLASH_SEC_SIZE) - 1);
+
+static bool hasShadowSector() {
+    return (uintptr_t)&_SPIFFS_end - (uintptr_t)&_SPIFFS_start >= SPI_FLASH_SEC_SIZE;
+}
+
+EEPROMSchemaClass EEPROMSchema;
+
+static uint32_t crc32(const uint8_t* data, int length) {
+    uint32_t crc = 0xffffffff;
+
+    for (int i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+
+    return ~crc;
+}
+
+EEPROMSchemaClass::EEPROMSchemaClass(): _storedVersion(0) {
+}
+
+void EEPROMSchemaClass::begin() {
+    EEPROM.begin(kEESize);
+    EEPROM.get(kEESchemaVersion, _storedVersion);
+
+    if (!hasShadowSector()) {
+        LOG_WARNING(EEPROMSchema, "no filesystem area for the shadow copy, commits are not reset safe\n");
+    }
+
+    LOG_INFO(EEPROMSchema, "stored schema version: %u, current: %u\n", _storedVersion, kSchemaVersion);
+
+    if (_storedVersion == kSchemaVersion && isValid(EEPROM.getConstDataPtr())) {
+        return;
+    }
+
+    // Every commit writes the shadow before the primary, and gives up if the shadow
+    // fails. So an invalid primary next to a valid shadow means the commit was
+    // interrupted while rewriting the primary, and the shadow holds the newer image.
+    if (restoreFromShadow()) {
+        return;
+    }
+
+    if (_storedVersion >= 1 && _storedVersion < kSchemaVersion && migrate()) {
+        return;
+    }
+
+    wipe();
+}
+
+int EEPROMSchemaClass::cellCount() const {
+    return sizeof(kCells) / sizeof(kCells[0]);
+}
+
+EEPROMCellDescriptor EEPROMSchemaClass::cell(int index) const {
+    EEPROMCellDescriptor descriptor;
+    memcpy_P(&descriptor, &kCells[index], sizeof(descriptor));
+    return descriptor;
+}
+
+void EEPROMSchemaClass::seal() {
+    uint32_t checksum = crc32(EEPROM.getConstDataPtr(), kEEChecksum);
+    EEPROM.put(kEEChecksum, checksum);
+}
+
+void EEPROMSchemaClass::dump() const {
+    static const int kBytesPerLine = 16;
+    const uint8_t* image = EEPROM.getConstDataPtr();
+
+    for (int i = 0; i < cellCount(); ++i) {
+        EEPROMCellDescriptor c = cell(i);
+
+        for (int j = 0; j < c.size; j += kBytesPerLine) {
+            // four bytes per word, in storage order
+            uint32_t words[kBytesPerLine / 4] = {0, 0, 0, 0};
+            for (int k = 0; k < kBytesPerLine && j + k < c.size; ++k) {
+                words[k / 4] |= uint32_t(image[c.offset + j + k]) << (24 - 8 * (k % 4));
+            }
+            LOG_DEBUG(EEPROMSchema, "%s @%u: %x %x %x %x\n",
+                      c.name, c.offset + j, words[0], words[1], words[2], words[3]);
+        }
+    }
+}
+
+bool EEPROMSchemaClass::isValid(const uint8_t* image) const {
+    uint16_t version = 0;
+    memcpy(&version, image + kEESchemaVersion, sizeof(version));
+    if (version != kSchemaVersion) {
+        return false;
+    }
+
+    uint32_t checksum = 0;
+    memcpy(&checksum, image + kEEChecksum, sizeof(checksum));
+    return checksum == crc32(image, kEEChecksum);
+}
+
+bool EEPROMSchemaClass::commit() {
+    seal();
+
+    if (!writeShadow()) {
+        return false;
+    }
+
+    return EEPROM.commit();
+}
+
+bool EEPROMSchemaClass::restoreFromShadow() {
+    if (!hasShadowSector()) {
+        return false;
+    }
+
+    ShadowEEPROM.begin(kEESize);
+    bool isRestored = false;
+
+    if (isValid(ShadowEEPROM.getConstDataPtr())) {
+        LOG_WARNING(EEPROMSchema, "restoring image from shadow copy\n");
+        memcpy(EEPROM.getDataPtr(), ShadowEEPROM.getConstDataPtr(), kEESize);
+        isRestored = EEPROM.commit();
+    }
+
+    ShadowEEPROM.end();
+    return isRestored;
+}
+
+bool EEPROMSchemaClass::migrate() {
+    uint8_t* image = EEPROM.getDataPtr();
+
+    for (uint16_t version = _storedVersion; version < kSchemaVersion; ++version) {
+        LOG_INFO(EEPROMSchema, "migrating schema %u to %u\n", version, version + 1);
+        if (!kMigrationSteps[version - 1](image)) {
+            LOG_ERROR(EEPROMSchema, "migration failed\n");
+            return false;
+        }
+    }
+
+    EEPROM.put(kEESchemaVersion, kSchemaVersion);
+
+    // Either the stored image is left as it was, or the shadow holds the migrated
+    // one; both are recovered on the next boot, so the migrated image is used meanwhile.
+    if (!commit()) {
+        LOG_ERROR(EEPROMSchema, "EEPROM commit failed\n");
+    }
+
+    return true;
+}
+
+void EEPROMSchemaClass::wipe() {
+    LOG_WARNING(EEPROMSchema, "no usable image found, resetting EEPROM\n");
+    memset(EEPROM.getDataPtr(), 0, kEESize);
+    EEPROM.put(kEESchemaVersion, kSchemaVersion);
+
+    // through the shadow as well, a stale shadow would otherwise survive the wipe
+    if (!commit()) {
+        LOG_ERROR(EEPROMSchema, "EEPROM commit failed\n");
+    }
+}
+
+bool EEPROMSchemaClass::writeShadow() {
+    if (!hasShadowSector()) {
+        return true;
+    }
+
+    ShadowEEPROM.begin(kEESize);
+    memcpy(ShadowEEPROM.getDataPtr(), EEPROM.getConstDataPtr(), kEESize);
+
+    bool isWritten = ShadowEEPROM.commit();
+    if (!isWritten) {
+        LOG_ERROR(EEPROMSchema, "shadow commit failed\n");
+    }
+
+    ShadowEEPROM.end();
+    return isWritten;
+}
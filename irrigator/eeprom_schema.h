@@ -0,0 +1,52 @@
+#ifndef __eeprom_schema_h
+#define __eeprom_schema_h
+
+#include <pgmspace.h>
+#include <stdint.h>
+#include "common.h"
+
+struct EEPROMCellDescriptor {
+    // in flash, like the descriptor table itself
+    PGM_P name;
+    uint16_t offset;
+    uint16_t size;
+};
+
+class EEPROMSchemaClass {
+public:
+    // upgrades an image of schema version N to N + 1 in place
+    typedef bool (*MigrationStep)(uint8_t* image);
+
+public:
+    EEPROMSchemaClass();
+
+    // loads the stored image into EEPROM, restoring or migrating it as needed
+    void begin();
+
+    uint16_t storedVersion() const { return _storedVersion; }
+
+    int cellCount() const;
+    EEPROMCellDescriptor cell(int index) const;
+
+    // Seals the image and commits it, to the shadow copy first and then to the
+    // primary sector, so that a commit interrupted by a reset can be completed
+    // from the shadow on the next boot. Every commit has to go through here.
+    bool commit();
+
+    void dump() const;
+
+private:
+    void seal();
+    bool isValid(const uint8_t* image) const;
+    bool restoreFromShadow();
+    bool migrate();
+    void wipe();
+    bool writeShadow();
+
+private:
+    uint16_t _storedVersion;
+};
+
+extern EEPROMSchemaClass EEPROMSchema;
+
+#endif // __eeprom_schema_h
@@ -0,0 +1,57 @@
+#ifndef __flow_counter_h
+#define __flow_counter_h
+
+#include <stdint.h>
+
+// Turns the raw pulse count of a flow meter into delivered volume. It is fed
+// snapshots of the free running counter maintained by the ISR together with the
+// time they were taken, and has no Arduino dependencies, so it can be driven on
+// the host with synthetic pulse trains.
+class FlowCounter {
+public:
+    FlowCounter(uint16_t pulsesPerLitre):
+        _pulsesPerLitre(pulsesPerLitre),
+        _basePulseCount(0),
+        _pulses(0),
+        _lastPulseMillis(0) {}
+
+    // starts a new measurement at the given counter value
+    void reset(uint32_t pulseCount, uint32_t nowMillis) {
+        _basePulseCount = pulseCount;
+        _pulses = 0;
+        _lastPulseMillis = nowMillis;
+    }
+
+    void update(uint32_t pulseCount, uint32_t nowMillis) {
+        // unsigned arithmetic copes with the counter wrapping around
+        uint32_t pulses = pulseCount - _basePulseCount;
+        if (pulses != _pulses) {
+            _pulses = pulses;
+            _lastPulseMillis = nowMillis;
+        }
+    }
+
+    uint32_t pulses() const { return _pulses; }
+
+    uint32_t millilitres() const {
+        return uint64_t(_pulses) * 1000 / _pulsesPerLitre;
+    }
+
+    bool hasReached(uint32_t targetMillilitres) const {
+        // compared in pulses, rounding the target up
+        return uint64_t(_pulses) * 1000 >= uint64_t(targetMillilitres) * _pulsesPerLitre;
+    }
+
+    // true if no pulse has arrived for at least timeoutMillis
+    bool isStalled(uint32_t nowMillis, uint32_t timeoutMillis) const {
+        return nowMillis - _lastPulseMillis >= timeoutMillis;
+    }
+
+private:
+    uint16_t _pulsesPerLitre;
+    uint32_t _basePulseCount;
+    uint32_t _pulses;
+    uint32_t _lastPulseMillis;
+};
+
+#endif // __flow_counter_h
@@ -0,0 +1,40 @@
+#include "flow_meter.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "persistence.h"
+
+FlowMeterClass FlowMeter;
+
+FlowMeterClass::FlowMeterClass(): _pulsesPerLitre(0), _pulseCount(0) {
+    for (int i = 0; i < kNumOutputValves; ++i) {
+        _totalMillilitres[i] = 0;
+    }
+}
+
+void FlowMeterClass::begin(uint8_t pin, uint16_t pulsesPerLitre) {
+    _pulsesPerLitre = pulsesPerLitre;
+    pinMode(pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pin), handlePulse, FALLING);
+    LOG_INFO(Irrigator, "flow meter on pin %u, %u pulses/l\n", pin, pulsesPerLitre);
+}
+
+// Everything else works on snapshots of the counter, see FlowCounter. A 32 bit
+// read is atomic, so they need no locking.
+void IRAM_ATTR FlowMeterClass::handlePulse() {
+    ++FlowMeter._pulseCount;
+}
+
+void FlowMeterClass::loadTotals() {
+    EEPROM.get(kEEFlowTotals, _totalMillilitres);
+}
+
+void FlowMeterClass::addToTotal(Valve valve, uint32_t millilitres) {
+    if (millilitres == 0) {
+        return;
+    }
+
+    _totalMillilitres[valve] += millilitres;
+    Persistence.put(PersistenceClass::kSubsystemFlowMeter, kEEFlowTotals + valve * sizeof(uint32_t),
+                    _totalMillilitres[valve]);
+}
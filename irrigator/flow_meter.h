@@ -0,0 +1,35 @@
+#ifndef __flow_meter_h
+#define __flow_meter_h
+
+#include <stdint.h>
+#include "common.h"
+
+// Counts the pulses of a hall effect flow meter on the main line in an ISR and
+// keeps the volume delivered through each output valve. Without begin() the
+// meter is disabled and volume based tasks fall back to their duration.
+class FlowMeterClass {
+public:
+    FlowMeterClass();
+
+    void begin(uint8_t pin, uint16_t pulsesPerLitre);
+    bool isEnabled() const { return _pulsesPerLitre != 0; }
+
+    uint16_t pulsesPerLitre() const { return _pulsesPerLitre; }
+    uint32_t pulseCount() const { return _pulseCount; }
+
+    void loadTotals();
+    void addToTotal(Valve valve, uint32_t millilitres);
+    uint32_t totalMillilitres(Valve valve) const { return _totalMillilitres[valve]; }
+
+private:
+    static void handlePulse();
+
+private:
+    uint16_t _pulsesPerLitre;
+    volatile uint32_t _pulseCount;
+    uint32_t _totalMillilitres[kNumOutputValves];
+};
+
+extern FlowMeterClass FlowMeter;
+
+#endif // __flow_meter_h
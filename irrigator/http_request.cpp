@@ -1,46 +1,104 @@
 #include <Stream.h>
 #include "http_request.h"
+#include "common.h"
 #include "string_ext.h"
 
-HTTPForm::HTTPForm(const String& str): _fields(nullptr) {
-    _fieldCount = occurrenceCount(str, '&') + 1;
+static const size_t kMaxLineLength = 256;
+static const size_t kMaxBodyLength = 1024;
 
-    if (_fieldCount == 0) {
-        return;
+size_t readHTTPLine(Stream& stream, char* buffer, size_t capacity) {
+    size_t length = stream.readBytesUntil('\n', buffer, capacity);
+    if (length == capacity) {
+        stream.find("\n");
     }
 
-    _fields = new HTTPFormField[_fieldCount];
-
-    String rest;
-    String field = bisect(str, "&", rest);
-    for (int i = 0; field.length() > 0; ++i) {
-        _fields[i].name = bisect(field, "=", _fields[i].value);
-        field = bisect(rest, "&", rest);
+    if (length > 0 && buffer[length - 1] == '\r') {
+        --length;
     }
+    return length;
+}
+
+// Decoding never grows its input, so it happens in place in the buffer the
+// view points into. A malformed escape is kept verbatim.
+static StrView decodeInPlace(char* buffer, const StrView& view) {
+    char* start = buffer + (view.data() - buffer);
+    int length = percentDecode(view.data(), view.length(), start, true);
+    return length >= 0 ? StrView(start, length) : view;
 }
 
+HTTPForm::HTTPForm(const String& str): _buffer(str) {
+    char* data = _buffer.begin();
+    StrView rest(data, _buffer.length());
+
+    while (!rest.isEmpty()) {
+        StrView field = rest.split("&", rest);
+        if (field.isEmpty()) {
+            continue;
+        }
+        if (_fields.isFull()) {
+            LOG_WARNING(WebService, "ignoring form fields beyond %u\n", uint32_t(kMaxFieldCount));
+            break;
+        }
+
+        StrView value;
+        StrView name = field.split("=", value);
+
+        HTTPFormField decoded;
+        decoded.name = decodeInPlace(data, name);
+        decoded.value = decodeInPlace(data, value);
+        _fields.append(decoded);
+    }
+}
 
 HTTPRequest::HTTPRequest(Stream& stream) {
-    String requestLine = stream.readStringUntil('\r');
-    // skip the \n
-    stream.read();
-    String tail;
+    // the request line and the headers go through one line buffer, only what
+    // is kept ends up on the heap
+    char line[kMaxLineLength];
+    StrView tail;
+
+    StrView requestLine(line, readHTTPLine(stream, line, sizeof(line)));
+    _method = requestLine.split(" ", tail).toString();
+    StrView url = tail.split(" ", tail);
+    StrView query;
+    _uri = url.split("?", query).toString();
+    _query = query.toString();
 
-    _method = bisect(requestLine, " ", tail);
-    String url = bisect(tail, " ", tail);
-    _uri = bisect(url, "?", _query);
+    size_t contentLength = 0;
+    for (size_t length; (length = readHTTPLine(stream, line, sizeof(line))) > 0; ) {
+        StrView value;
+        StrView name = StrView(line, length).split(": ", value);
 
-    String headerLine = stream.readStringUntil('\r');
-    stream.read();
+        if (name.equalsIgnoreCase(F("Content-Length"))) {
+            contentLength = value.toUInt();
+        }
+
+        if (_headers.isFull()) {
+            LOG_WARNING(WebService, "dropping header %s\n", name.toString());
+            continue;
+        }
 
-    while (headerLine.length() > 0) {
         HTTPHeaderField header;
-        header.name = bisect(headerLine, ": ", header.value);
-        _headers.append(header);
+        header.name = name.toString();
+        header.value = value.toString();
+        _headers.append(std::move(header));
+    }
 
-        headerLine = stream.readStringUntil('\r');
-        stream.read();
+    // Without a Content-Length there is no body. Reading until the client stops
+    // sending would instead wait out the stream timeout on every request.
+    if (contentLength > kMaxBodyLength) {
+        LOG_WARNING(WebService, "truncating %u byte body\n", contentLength);
+        contentLength = kMaxBodyLength;
+    }
+    if (contentLength > 0 && _body.reserve(contentLength)) {
+        char chunk[64];
+        size_t remaining = contentLength;
+        while (remaining > 0) {
+            size_t length = stream.readBytes(chunk, remaining < sizeof(chunk) ? remaining : sizeof(chunk));
+            if (length == 0) {
+                break;
+            }
+            _body.concat(chunk, length);
+            remaining -= length;
+        }
     }
-    
-    _body = stream.readString();
 }
@@ -2,30 +2,38 @@
 #define __http_request_h
 
 #include <WString.h>
-#include "linked_list.h"
+#include "static_vector.h"
+#include "str_view.h"
 
 class Stream;
 
+// Reads a CRLF terminated line into buffer, without the terminator. Lines that
+// do not fit are cut, the rest of them is skipped. Returns the length read.
+extern size_t readHTTPLine(Stream& stream, char* buffer, size_t capacity);
+
 struct HTTPFormField {
-    String name;
-    String value;
+    StrView name;
+    StrView value;
 };
 
+// The fields of a URL encoded form. The form decodes a copy of its input in
+// place and the fields are views into it, so it cannot be copied.
 class HTTPForm {
+public:
+    // fields beyond this are ignored
+    static const size_t kMaxFieldCount = 8;
+
 public:
     HTTPForm(const String& str);
-    ~HTTPForm() {
-        if (_fields) {
-            delete[] _fields;
-        }
-    }
+    HTTPForm(const HTTPForm&) = delete;
+    HTTPForm& operator=(const HTTPForm&) = delete;
 
-    const int fieldCount() const { return _fieldCount; }
+    const int fieldCount() const { return _fields.size(); }
     const HTTPFormField& field(int index) const { return _fields[index]; }
 
 private:
-    int _fieldCount;
-    HTTPFormField* _fields;
+    String _buffer;
+    StaticVector<HTTPFormField, kMaxFieldCount> _fields;
 };
 
 struct HTTPHeaderField {
@@ -34,6 +42,11 @@ struct HTTPHeaderField {
 };
 
 class HTTPRequest {
+public:
+    // headers beyond this are dropped, none of the routes needs more than a few
+    static const size_t kMaxHeaderCount = 16;
+    typedef StaticVector<HTTPHeaderField, kMaxHeaderCount> Headers;
+
 public:
     HTTPRequest(Stream& stream);
 
@@ -41,14 +54,14 @@ public:
     const String& uri() const { return _uri; }
     const String& query() const { return _query; }
     const String& body() const { return _body; }
-    const LinkedList<HTTPHeaderField>& headers() const { return _headers; }
+    const Headers& headers() const { return _headers; }
 
 private:
     String _method;
     String _uri;
     String _query;
     String _body;
-    LinkedList<HTTPHeaderField> _headers;
+    Headers _headers;
 };
 
 #endif // __http_request_h
@@ -1,19 +1,22 @@
 #include <Stream.h>
 #include "http_response.h"
-#include "string_ext.h"
+#include "http_request.h"
+#include "str_view.h"
 #include "common.h"
 
 HTTPResponse::HTTPResponse(Stream& stream, bool shouldParseBody) {
-    String statusLine = stream.readStringUntil('\r');
-    
-    String tail;
-    String head = bisect(statusLine, " ", tail);
+    // only the status code is needed from the status line
+    char line[32];
+    StrView statusLine(line, readHTTPLine(stream, line, sizeof(line)));
+
+    StrView tail;
+    statusLine.split(" ", tail);
     _statusCode = tail.toInt();
 
     if (!shouldParseBody) {
         return;
     }
 
-    stream.find("\n\r\n");
+    stream.find("\r\n\r\n");
     _body = stream.readString();
 }
@@ -0,0 +1,165 @@
+#ifndef __intrusive_list_h
+#define __intrusive_list_h
+
+#include <stddef.h>
+
+// The links an element of an IntrusiveList carries in itself. An element can be
+// in at most one list at a time and must outlive its membership.
+class IntrusiveListNode {
+public:
+    IntrusiveListNode(): _prev(nullptr), _next(nullptr), _isLinked(false) {}
+
+    // copies start out unlinked, links belong to the original
+    IntrusiveListNode(const IntrusiveListNode&): _prev(nullptr), _next(nullptr), _isLinked(false) {}
+    IntrusiveListNode& operator=(const IntrusiveListNode&) { return *this; }
+
+    bool isLinked() const { return _isLinked; }
+
+private:
+    template <typename T> friend class IntrusiveList;
+
+    IntrusiveListNode* _prev;
+    IntrusiveListNode* _next;
+    bool _isLinked;
+};
+
+// A doubly linked list of elements deriving from IntrusiveListNode. It owns
+// neither the elements nor any memory, so its bound is that of the storage the
+// elements live in, e.g. a StaticVector or a static array.
+template <typename T>
+class IntrusiveList {
+public:
+    class Iterator {
+    public:
+        Iterator(IntrusiveListNode* node): _node(node) {}
+
+        T& operator*() const { return *static_cast<T*>(_node); }
+        T* operator->() const { return static_cast<T*>(_node); }
+        Iterator& operator++() {
+            _node = _node->_next;
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return _node != other._node; }
+
+    private:
+        IntrusiveListNode* _node;
+    };
+
+public:
+    IntrusiveList(): _head(nullptr), _tail(nullptr), _size(0) {}
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    IntrusiveList(IntrusiveList&& other): _head(other._head), _tail(other._tail), _size(other._size) {
+        other._head = other._tail = nullptr;
+        other._size = 0;
+    }
+
+    IntrusiveList& operator=(IntrusiveList&& other) {
+        if (this != &other) {
+            clear();
+            _head = other._head;
+            _tail = other._tail;
+            _size = other._size;
+            other._head = other._tail = nullptr;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    ~IntrusiveList() { clear(); }
+
+    size_t size() const { return _size; }
+    bool isEmpty() const { return _size == 0; }
+
+    T* first() const { return static_cast<T*>(_head); }
+    T* last() const { return static_cast<T*>(_tail); }
+
+    Iterator begin() const { return Iterator(_head); }
+    Iterator end() const { return Iterator(nullptr); }
+
+    // returns false if the element is already in a list
+    bool append(T& item) {
+        IntrusiveListNode* node = &item;
+        if (node->_isLinked) {
+            return false;
+        }
+
+        node->_prev = _tail;
+        node->_next = nullptr;
+        node->_isLinked = true;
+        if (_tail) {
+            _tail->_next = node;
+        }
+        else {
+            _head = node;
+        }
+        _tail = node;
+        ++_size;
+        return true;
+    }
+
+    bool prepend(T& item) {
+        IntrusiveListNode* node = &item;
+        if (node->_isLinked) {
+            return false;
+        }
+
+        node->_prev = nullptr;
+        node->_next = _head;
+        node->_isLinked = true;
+        if (_head) {
+            _head->_prev = node;
+        }
+        else {
+            _tail = node;
+        }
+        _head = node;
+        ++_size;
+        return true;
+    }
+
+    // the element has to be in this list
+    void remove(T& item) {
+        IntrusiveListNode* node = &item;
+
+        if (node->_prev) {
+            node->_prev->_next = node->_next;
+        }
+        else {
+            _head = node->_next;
+        }
+        if (node->_next) {
+            node->_next->_prev = node->_prev;
+        }
+        else {
+            _tail = node->_prev;
+        }
+
+        node->_prev = node->_next = nullptr;
+        node->_isLinked = false;
+        --_size;
+    }
+
+    T* removeFirst() {
+        T* item = first();
+        if (item) {
+            remove(*item);
+        }
+        return item;
+    }
+
+    void clear() {
+        while (_head) {
+            removeFirst();
+        }
+    }
+
+private:
+    IntrusiveListNode* _head;
+    IntrusiveListNode* _tail;
+    size_t _size;
+};
+
+#endif // __intrusive_list_h
@@ -2,8 +2,24 @@
 #include <Arduino.h>
 #include <WString.h>
 #include "irrigator.h"
+#include "flow_meter.h"
+#include "scheduler.h"
+
+IrrigatorClass Irrigator;
+
+IrrigatorClass::IrrigatorClass():
+    _openValvesMask(0),
+    _outputValvesMask(0),
+    _switchingValvesMask(0),
+    _pendingCloseMask(0),
+    _hasActiveTask(false),
+    _taskStartMillis(0),
+    _flowCounter(1) {
+    for (int i = 0; i < kNumValveTypes; ++i) {
+        _openTransientTime[i] = kDefaultTransientTime;
+        _closeTransientTime[i] = kDefaultTransientTime;
+    }
 
-IrrigatorClass::IrrigatorClass() : _openValvesMask(0), _outputValvesMask(0) {
     pinMode(pinForValve(kValveMaster), OUTPUT);
 
     for (int i = 0; i < kNumOutputValves; ++i) {
@@ -15,43 +31,219 @@ IrrigatorClass::IrrigatorClass() : _openValvesMask(0), _outputValvesMask(0) {
     reset();
 }
 
+void IrrigatorClass::setTransientTimes(ValveType type, Milliseconds openTime, Milliseconds closeTime) {
+    _openTransientTime[type] = openTime;
+    _closeTransientTime[type] = closeTime;
+}
+
+// Switching a valve only starts its transient and records when it will have
+// settled. Callers wait for the valves they depend on, so that independent
+// transients overlap.
 void IrrigatorClass::openValve(Valve valve) {
-    LOG(String(F("opening valve ")) + String(valve) + "\n");
+    LOG_DEBUG(Irrigator, "opening valve %u\n", valve);
     if (valve != kValveMaster) {
         ensureAllOutputValvesAreClosed();
     }
     
     _openValvesMask |= 1 << valve;
     digitalWrite(pinForValve(valve), LOW);
-    delay(kValveOpenTransientTime);
+
+    ValveType type = valve == kValveMaster ? kValveTypeMaster : kValveTypeOutput;
+    _settleDeadlineMillis[valve] = millis() + _openTransientTime[type];
+    _switchingValvesMask |= 1 << valve;
 }
 
 void IrrigatorClass::closeValve(Valve valve) {
-    LOG(String(F("closing valve ")) + String(valve) + "\n");
+    LOG_DEBUG(Irrigator, "closing valve %u\n", valve);
     digitalWrite(pinForValve(valve), HIGH);
     _openValvesMask &= ~(1 << valve);
-    delay(kValveCloseTransientTime);
+    _pendingCloseMask &= ~(1 << valve);
+
+    ValveType type = valve == kValveMaster ? kValveTypeMaster : kValveTypeOutput;
+    _settleDeadlineMillis[valve] = millis() + _closeTransientTime[type];
+    _switchingValvesMask |= 1 << valve;
+}
+
+bool IrrigatorClass::hasSettled(Valve valve, uint32_t now) const {
+    return !(_switchingValvesMask & (1 << valve)) || int32_t(now - _settleDeadlineMillis[valve]) >= 0;
+}
+
+void IrrigatorClass::settleValves(uint32_t now) {
+    for (Valve v = 0; v < kNumValves; ++v) {
+        if (hasSettled(v, now)) {
+            _switchingValvesMask &= ~(1 << v);
+        }
+    }
+}
+
+void IrrigatorClass::waitForValves(uint8_t mask) {
+    for (;;) {
+        uint32_t now = millis();
+        settleValves(now);
+        if (!(_switchingValvesMask & mask)) {
+            return;
+        }
+
+        uint32_t latestDeadline = now;
+        for (Valve v = 0; v < kNumValves; ++v) {
+            if ((_switchingValvesMask & mask & (1 << v)) && int32_t(_settleDeadlineMillis[v] - latestDeadline) > 0) {
+                latestDeadline = _settleDeadlineMillis[v];
+            }
+        }
+        delay(latestDeadline - now);
+    }
+}
+
+void IrrigatorClass::update() {
+    if (_pendingCloseMask && hasSettled(kValveMaster, millis())) {
+        for (int i = 0; i < kNumOutputValves; ++i) {
+            Valve v = outputValves[i];
+            if (_pendingCloseMask & (1 << v)) {
+                closeValve(v);
+            }
+        }
+    }
+
+    settleValves(millis());
+}
+
+void IrrigatorClass::waitUntilIdle() {
+    waitForValves(1 << kValveMaster);
+    update();
+    waitForValves(0xff);
+}
+
+TimeInterval IrrigatorClass::timeIntervalTillUpdate() const {
+    uint32_t now = millis();
+
+    if (_hasActiveTask) {
+        if (_activeTask.volumeDecilitres > 0 && FlowMeter.isEnabled()) {
+            return TimeInterval::withMilliseconds(kTaskPollInterval);
+        }
+
+        int32_t remainingMillis = int32_t(_taskStartMillis + uint32_t(_activeTask.duration) * 1000 - now);
+        return TimeInterval::withMilliseconds(remainingMillis > 0 ? remainingMillis : 0);
+    }
+
+    if (_pendingCloseMask) {
+        int32_t remainingMillis = hasSettled(kValveMaster, now) ? 0 : int32_t(_settleDeadlineMillis[kValveMaster] - now);
+        return TimeInterval::withMilliseconds(remainingMillis);
+    }
+
+    return SchedulerClass::noDeadline();
 }
 
 void IrrigatorClass::performTask(Task& task) {
-    LOG(String(F("starting task for valve ")) + String(task.valve) + ": " + String(task.duration) + " sec\n");
+    beginTask(task);
+    while (!updateTask()) {
+        delay(kTaskPollInterval);
+    }
+    endTask();
+}
+
+void IrrigatorClass::beginTask(const Task& task) {
+    LOG_INFO(Irrigator, "starting task for valve %u: %u sec, %u dl\n", task.valve, task.duration, task.volumeDecilitres);
+
+    _activeTask = task;
+    _hasActiveTask = true;
+
+    // the whole span is metered, so the totals include what flows during the transients
+    _flowCounter = FlowCounter(FlowMeter.isEnabled() ? FlowMeter.pulsesPerLitre() : 1);
+    _flowCounter.reset(FlowMeter.pulseCount(), millis());
+
+    // opening the zone overlaps with the master and the previous zone shutting,
+    // but the master only opens onto a zone that is fully open
     openValve(task.valve);
+    waitForValves((1 << task.valve) | (1 << kValveMaster));
     openValve(kValveMaster);
 
-    delay(task.duration * 1000);
+    // the task is timed from when the master has opened, without waiting for it
+    _taskStartMillis = _settleDeadlineMillis[kValveMaster];
+}
+
+bool IrrigatorClass::updateTask() {
+    uint32_t now = millis();
+    settleValves(now);
+
+    if (int32_t(now - _taskStartMillis) < 0) {
+        return false;
+    }
+
+    uint32_t elapsedMillis = now - _taskStartMillis;
+    bool isVolumeBased = _activeTask.volumeDecilitres > 0 && FlowMeter.isEnabled();
+
+    if (!isVolumeBased) {
+        return elapsedMillis >= uint32_t(_activeTask.duration) * 1000;
+    }
 
+    _flowCounter.update(FlowMeter.pulseCount(), now);
+    uint32_t targetMillilitres = uint32_t(_activeTask.volumeDecilitres) * 100;
+
+    if (_flowCounter.hasReached(targetMillilitres)) {
+        return true;
+    }
+
+    // the duration still bounds the run, in case the meter undercounts
+    if (elapsedMillis >= uint32_t(_activeTask.duration) * 1000) {
+        LOG_WARNING(Irrigator, "valve %u timed out after %u of %u ml\n",
+                    _activeTask.valve, _flowCounter.millilitres(), targetMillilitres);
+        return true;
+    }
+
+    if (_flowCounter.isStalled(now, kFlowStallTimeout)) {
+        LOG_ERROR(Irrigator, "no flow through valve %u after %u ml\n", _activeTask.valve, _flowCounter.millilitres());
+        return true;
+    }
+
+    return false;
+}
+
+void IrrigatorClass::endTask() {
+    // The zone closes once the master has shut, either from update() or when the
+    // next task opens its zone, so that the two transients overlap.
     closeValve(kValveMaster);
-    closeValve(task.valve);
-    LOG(String(F("finishing task for valve ")) + String(task.valve) + "\n");
+    _pendingCloseMask |= 1 << _activeTask.valve;
+    _hasActiveTask = false;
+
+    if (FlowMeter.isEnabled()) {
+        _flowCounter.update(FlowMeter.pulseCount(), millis());
+        FlowMeter.addToTotal(_activeTask.valve, _flowCounter.millilitres());
+        LOG_INFO(Irrigator, "finishing task for valve %u: %u ml\n", _activeTask.valve, _flowCounter.millilitres());
+    }
+    else {
+        LOG_INFO(Irrigator, "finishing task for valve %u\n", _activeTask.valve);
+    }
+}
+
+uint32_t IrrigatorClass::activeTaskElapsedMillis() const {
+    if (!_hasActiveTask) {
+        return 0;
+    }
+
+    int32_t elapsedMillis = int32_t(millis() - _taskStartMillis);
+    return elapsedMillis > 0 ? elapsedMillis : 0;
+}
+
+uint32_t IrrigatorClass::activeTaskMillilitres() const {
+    if (!_hasActiveTask || !FlowMeter.isEnabled()) {
+        return 0;
+    }
+
+    FlowCounter counter = _flowCounter;
+    counter.update(FlowMeter.pulseCount(), millis());
+    return counter.millilitres();
 }
 
 void IrrigatorClass::reset() {
+    // all valves close at once, the master first
     closeValve(kValveMaster);
 
     for (int i = 0; i < kNumOutputValves; ++i) {
         Valve v = outputValves[i];
         closeValve(v);
     }
+
+    waitForValves(0xff);
 }
 
 void IrrigatorClass::ensureAllOutputValvesAreClosed() {
@@ -61,10 +253,11 @@ void IrrigatorClass::ensureAllOutputValvesAreClosed() {
 
     for (int i = 0; i < kNumOutputValves; ++i) {
         Valve v = outputValves[i];
-        if (_openValvesMask & (1 << v)) {
-            LOG(String(F("WARNING: valve ")) + String(v) +
-                String(F(" was already open when trying to open valve ")) +
-                String(v) + "\n");
+        if (_pendingCloseMask & (1 << v)) {
+            closeValve(v);
+        }
+        else if (_openValvesMask & (1 << v)) {
+            LOG_WARNING(Irrigator, "valve %u was already open when trying to open valve %u\n", v, v);
             closeValve(v);
         }
     }
@@ -75,5 +268,5 @@ uint8_t IrrigatorClass::pinForValve(Valve valve) {
 }
 
 void IrrigatorClass::logOpenMask() {
-    LOG(String(F("open valves mask = ")) + String(_openValvesMask, BIN) + "\n");
+    LOG_DEBUG(Irrigator, "open valves mask = %x\n", _openValvesMask);
 }
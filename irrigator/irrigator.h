@@ -2,21 +2,53 @@
 #define __irrigator_h
 
 #include "common.h"
+#include "flow_counter.h"
+#include "time.h"
+
+typedef enum {
+    kValveTypeOutput = 0,
+    kValveTypeMaster,
+
+    kNumValveTypes
+} ValveType;
 
 class IrrigatorClass {
 public:
     struct Task {
         Valve valve;
         Seconds duration;
+        // 0 for time based tasks, otherwise duration only caps the run
+        uint16_t volumeDecilitres;
     };
 
 public:
     IrrigatorClass();
 
+    // runs a task to completion, blocking
     void performTask(Task& task);
+
+    // Runs a task step by step from the loop: beginTask opens the valves, updateTask
+    // returns true once the task should stop and endTask closes them again.
+    void beginTask(const Task& task);
+    bool updateTask();
+    void endTask();
+
+    bool hasActiveTask() const { return _hasActiveTask; }
+    const Task& activeTask() const { return _activeTask; }
+    uint32_t activeTaskElapsedMillis() const;
+    uint32_t activeTaskMillilitres() const;
+
+    // closes the valves left open by endTask once the master has shut
+    void update();
+    // blocks until no valve is open or switching
+    void waitUntilIdle();
+    TimeInterval timeIntervalTillUpdate() const;
+
     void reset();
+    void setTransientTimes(ValveType type, Milliseconds openTime, Milliseconds closeTime);
     
-    const bool isBusy() const { return _openValvesMask != 0; }
+    const bool isBusy() const { return _openValvesMask != 0 || _switchingValvesMask != 0; }
+    uint8_t openValvesMask() const { return _openValvesMask; }
 
 private:
     void openValve(Valve valve);
@@ -25,14 +57,34 @@ private:
     uint8_t pinForValve(Valve valve);
     void logOpenMask();
 
+    bool hasSettled(Valve valve, uint32_t now) const;
+    void settleValves(uint32_t now);
+    void waitForValves(uint8_t mask);
+
 private:
-    static const Milliseconds kValveOpenTransientTime = 500;
-    static const Milliseconds kValveCloseTransientTime = 500;
+    static const Milliseconds kDefaultTransientTime = 500;
+    static const Milliseconds kTaskPollInterval = 100;
+    static const Milliseconds kFlowStallTimeout = 10000;
+    static const int kNumValves = kNumOutputValves + 1;
 
     uint8_t _openValvesMask;
     uint8_t _outputValvesMask;
+
+    // valves that have been switched and are still in their transient
+    uint8_t _switchingValvesMask;
+    uint32_t _settleDeadlineMillis[kNumValves];
+    // output valves to close as soon as the master has shut
+    uint8_t _pendingCloseMask;
+
+    Milliseconds _openTransientTime[kNumValveTypes];
+    Milliseconds _closeTransientTime[kNumValveTypes];
+
+    bool _hasActiveTask;
+    Task _activeTask;
+    uint32_t _taskStartMillis;
+    FlowCounter _flowCounter;
 };
 
-static IrrigatorClass Irrigator;
+extern IrrigatorClass Irrigator;
 
 #endif // __irrigator_h
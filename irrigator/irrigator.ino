@@ -1,55 +1,88 @@
 #include <ESP8266WiFi.h>
 #include <EEPROM.h>
-#include <Ticker.h>
+#include <user_interface.h>
 #include "clock.h"
 #include "common.h"
 #include "ddns.h"
+#include "eeprom_schema.h"
+#include "flow_meter.h"
 #include "duty_cycle_manager.h"
 #include "http_request.h"
+#include "irrigator.h"
 #include "moisture_logger.h"
+#include "persistence.h"
+#include "power_manager.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "string_ext.h"
+#include "syslog.h"
 #include "thingtweet.h"
+#include "valve_queue.h"
+#include "watchdog.h"
 #include "webservice.h"
+#include "wifi_connection.h"
 
-static const TimeInterval kConnectionTimeout = TimeInterval::withSeconds(10);
-static const TimeInterval kWatchdogTimerInterval = TimeInterval::withSeconds(30);
+static const char kSSID[] = "*";
+static const char kPassword[] = "*";
 
-Ticker watchdog;
+static constexpr TimeInterval kConnectionTimeout = 10_s;
+static constexpr TimeInterval kWatchdogTimerInterval = 30_s;
 
-void watchdogHandler() {
-    LOG(F("[main] watchdog alert: loop is stuck, resetting board.\n"));
-    tweetStatus("[main] watchdog alert: loop is stuck, resetting board");
+// address of the syslog collector the log is forwarded to, forwarding is disabled if empty
+static const char kSyslogServer[] = "";
+static const uint16_t kSyslogPort = SyslogClass::kDefaultPort;
 
-    void (*resetBoard)(void) = 0;
-    resetBoard();
-}
+// Sleep deeply between deadlines, for solar powered sites. The board is unreachable
+// while asleep, and GPIO16 has to be wired to RST for it to wake up.
+static const bool kIsDeepSleepAllowed = false;
 
-bool ensureWifiConnection() {
-    if (WiFi.status() == WL_CONNECTED) {
-        return true;
-    }
+// time the valves take to settle after switching, independent transients overlap
+static const Milliseconds kOutputValveOpenTime = 500;
+static const Milliseconds kOutputValveCloseTime = 500;
+static const Milliseconds kMasterValveOpenTime = 500;
+static const Milliseconds kMasterValveCloseTime = 500;
 
-    const char ssid[] = "*";
-    const char password[] = "*";
-    LOG(String(F("\n\nConnecting to ")) + ssid);
+// hall effect flow meter on the main line, volume based tasks run by time without it
+static const bool kIsFlowMeterInstalled = false;
+static const uint8_t kFlowMeterPinD = 7;
+static const uint16_t kFlowMeterPulsesPerLitre = 450;
 
-    WiFi.begin(ssid, password);
+void reportSystemWatchdogReset() {
+    const __FlashStringHelper* watchdog = WatchdogClass::systemWatchdogName();
+    if (!watchdog) {
+        return;
+    }
 
-    DeviceTime startTime = Clock.deviceTime();
+    LOG_ERROR(Main, "watchdog reset: %s watchdog fired at %08x\n", watchdog, ESP.getResetInfoPtr()->epc1);
 
-    while (WiFi.status() != WL_CONNECTED) {
-        if (Clock.deviceTime().timeIntervalSince(startTime) > kConnectionTimeout) {
-            LOG(F("\nCouldn't connect to WiFi\n"));
-            return false;
-        }
-        delay(500);
-        LOG(".");
+    String status = F("[main] watchdog reset: ");
+    status += watchdog;
+    status += F(" watchdog fired");
+    tweetStatus(status);
+}
+
+void reportWatchdogReset() {
+    WatchdogClass::Snapshot snapshot;
+    if (!Watchdog.takeLastSnapshot(snapshot)) {
+        reportSystemWatchdogReset();
+        return;
     }
 
-    LOG(F("\nWiFi connected\n"));
+    const __FlashStringHelper* subsystem = WatchdogClass::subsystemName(snapshot.subsystem);
+    const __FlashStringHelper* stage = ProfilerClass::probeName(ProfilerProbe(snapshot.lastStage));
 
-    return true;
-}
+    LOG_ERROR(Main, "watchdog reset: %s stalled after stage %s, %ums overdue\n",
+              subsystem, stage, snapshot.overdueMillis);
+    LOG_ERROR(Main, "watchdog reset: loop #%u, uptime %ums, heap %u (max block %u), open valves %x\n",
+              snapshot.loopCount, snapshot.uptimeMillis, snapshot.freeHeap, snapshot.maxFreeBlockSize,
+              snapshot.openValvesMask);
 
+    String status = F("[main] watchdog reset: ");
+    status += subsystem;
+    status += F(" stalled after stage ");
+    status += stage;
+    tweetStatus(status);
+}
 
 WiFiServer server(8000);
 
@@ -71,78 +104,127 @@ void setup() {
     delay(10);
     #endif
 
-    LOG(String(F("[main] EEPROM size: ")) + String(kEESize) + "\n");
+    LOG_INFO(Main, "firmware version: %u\n", kFirmwareVersion);
+    LOG_INFO(Main, "EEPROM size: %u\n", kEESize);
 
-    EEPROM.begin(kEESize);
-    uint16_t firmwareVersion = -1;
-    EEPROM.get(kEEFirmwareVersion, firmwareVersion);
+    EEPROMSchema.begin();
+    EEPROMSchema.dump();
 
-    if (firmwareVersion != kFirmwareVersion) {
-        // reset EEPROM
-        LOG(F("[main] firmware version changed, resetting EEPROM\n"));
-        uint8_t* ptr = EEPROM.getDataPtr();
-        memset(ptr, 0, kEESize);
-        EEPROM.put(kEEFirmwareVersion, kFirmwareVersion);
-        EEPROM.commit();
-    }
-
-    uint8_t* ptr = EEPROM.getDataPtr();
-    for (int i = 0; i < kEESize; ++i, ++ptr) {
-        LOG(String(*ptr, 16) + " ");
-        if (i % 16 == 15) {
-            LOG("\n");
-        }
-    }
-    LOG("\n");
+    #if DEBUG
+    Clock.benchmark();
+    #endif
 
     Clock.loadUptime();
     DutyCycleManager.loadState();
+    Irrigator.setTransientTimes(kValveTypeOutput, kOutputValveOpenTime, kOutputValveCloseTime);
+    Irrigator.setTransientTimes(kValveTypeMaster, kMasterValveOpenTime, kMasterValveCloseTime);
+    if (kIsFlowMeterInstalled) {
+        FlowMeter.loadTotals();
+        FlowMeter.begin(pinD[kFlowMeterPinD], kFlowMeterPulsesPerLitre);
+    }
 
-    ensureWifiConnection();
+    WiFiConnection.begin(kSSID, kPassword);
+    WiFiConnection.waitForConnection(kConnectionTimeout);
+    reportWatchdogReset();
+
+    IPAddress syslogServer;
+    if (syslogServer.fromString(kSyslogServer)) {
+        Syslog.begin(syslogServer, kSyslogPort);
+    }
 
     server.begin();
 
-    watchdog.once(kWatchdogTimerInterval.seconds(), watchdogHandler);
+    PowerManager.begin(kIsDeepSleepAllowed);
+    Scheduler.addDeadlineSource(F("wifi"), []() { return WiFiConnection.timeIntervalTillNextAttempt(); });
+    Scheduler.addDeadlineSource(F("ddns"), []() { return DDNS.timeIntervalTillNextUpdate(); });
+    Scheduler.addDeadlineSource(F("clock"), []() { return Clock.timeIntervalTillNextSync(); });
+    Scheduler.addDeadlineSource(F("valve_queue"), []() { return ValveQueue.timeIntervalTillNextStep(); });
+    Scheduler.addDeadlineSource(F("duty_cycle"), []() {
+        // a cycle that is due while the queue drains must not keep the loop spinning
+        return ValveQueue.isActive() ? SchedulerClass::noDeadline() : DutyCycleManager.timeIntervalTillNextCycle();
+    });
+    Scheduler.addDeadlineSource(F("moisture"), []() { return MoistureLogger.timeIntervalTillNextSample(); });
+    Scheduler.addDeadlineSource(F("eeprom"), []() { return Persistence.timeIntervalTillCommit(); });
+    Scheduler.addDeadlineSource(F("syslog"), []() { return Syslog.timeIntervalTillFlush(); });
+    Scheduler.addWakeCondition(F("http"), []() { return server.hasClient(); });
+    Scheduler.addWakeCondition(F("wifi_event"), []() { return WiFiConnection.hasPendingEvent(); });
+
+    Watchdog.begin();
+    Watchdog.arm(kWatchdogLoop, kWatchdogTimerInterval);
+
+    #if DEBUG
+    Logger.drain(Serial);
+    #endif
 }
 
 void loop() {
     unsigned long startTime = millis();
-    LOG(F("loop starts\n"));
+    LOG_DEBUG(Main, "loop starts\n");
+
+    Profiler.beginLoop();
+    Clock.takeSnapshot();
 
-    ensureWifiConnection();
+    WiFiConnection.maintain();
+    Profiler.lap(kProbeWiFi);
 
     DDNS.updateDDNS();
+    Profiler.lap(kProbeDDNS);
 
     // Check if a client has connected
     WiFiClient client = server.available();
     if (client) {
         serve(client);
     }
+    Profiler.lap(kProbeServe, client);
 
     Clock.sync();
+    Profiler.lap(kProbeClockSync);
+
+    ValveQueue.run();
+    Profiler.lap(kProbeValveQueue, ValveQueue.isActive());
 
-    if (DutyCycleManager.isDue()) {
-        watchdog.detach();
-        tweetStatus("[main] starting cycle");
+    // manual commands go first, a due cycle waits until the queue has drained
+    bool isCycleDue = !ValveQueue.isActive() && DutyCycleManager.isDue();
+    if (isCycleDue) {
+        tweetStatus(F("[main] starting cycle"));
 
+        // the duty cycle keeps its own heartbeat with a budget for each task
+        Watchdog.disarm(kWatchdogLoop);
         DutyCycleManager.run();
+        Watchdog.arm(kWatchdogLoop, kWatchdogTimerInterval);
 
-        tweetStatus("[main] cycle is over");
-        watchdog.once(kWatchdogTimerInterval.seconds(), watchdogHandler);
+        tweetStatus(F("[main] cycle is over"));
+
+        // the cycle blocked for its whole duration, the rest of the iteration
+        // must not see the time from before it
+        Clock.takeSnapshot();
     }
+    Profiler.lap(kProbeDutyCycle, isCycleDue);
 
     int moisture = MoistureLogger.sample();
+    Profiler.lap(kProbeMoistureSample);
     if (moisture > 0) {
         MoistureLogger.submitToThingspeak(moisture);
     }
+    Profiler.lap(kProbeMoistureSubmit, moisture > 0);
 
-    if (!EEPROM.commit()) {
-        LOG(F("[main] EEPROM commit failed\n"));
+    if (!Persistence.commitIfDue()) {
+        LOG_ERROR(Main, "EEPROM commit failed\n");
     }
+    Profiler.lap(kProbeEEPROMCommit);
+
+    Syslog.flush();
+    Profiler.lap(kProbeSyslog);
 
-    watchdog.once(kWatchdogTimerInterval.seconds(), watchdogHandler);
+    Watchdog.feed(kWatchdogLoop);
+    Profiler.endLoop();
 
     unsigned long endTime = millis();
-    LOG(String(F("loop ends (")) + String(endTime - startTime) + "ms)\n");
-    delay(200);
+    LOG_DEBUG(Main, "loop ends (%ums)\n", endTime - startTime);
+
+    #if DEBUG
+    Logger.drain(Serial);
+    #endif
+
+    Scheduler.sleep();
 }
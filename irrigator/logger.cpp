@@ -0,0 +1,214 @@
+#include "logger.h"
+
+#include <Arduino.h>
+#include <Print.h>
+#include <string.h>
+#include "common.h"
+#include "string_ext.h"
+
+static constexpr char kModuleNames[] PROGMEM =
+    "main\0" "Clock\0" "DDNS\0" "DutyCycleManager\0" "EEPROMSchema\0"
+    "Irrigator\0" "MoistureLogger\0" "Persistence\0" "thingtweet\0" "webservice";
+static const char kLevelTags[] PROGMEM = "-EWID";
+
+static_assert(flashStringCount(kModuleNames, sizeof(kModuleNames)) == kNumLogModules,
+              "every log module needs a name");
+
+// stored in place of the seconds of TimeInterval::neverInThePast/neverInTheFuture
+static const int32_t kNeverSeconds = INT32_MIN;
+
+LoggerClass Logger;
+
+LoggerClass::LoggerClass(): _head(0), _count(0), _nextSequence(0), _drainCursor(0) {
+}
+
+LoggerClass::Record& LoggerClass::beginRecord(uint8_t module, uint8_t level, PGM_P format) {
+    if (_count == kCapacity) {
+        // overwrite the oldest record
+        _head = (_head + 1) % kCapacity;
+        --_count;
+    }
+
+    Record& record = _records[(_head + _count) % kCapacity];
+    ++_count;
+    ++_nextSequence;
+
+    record.timestamp = millis();
+    record.format = format;
+    record.module = module;
+    record.level = level;
+    record.textLength = 0;
+    record.textArguments = 0;
+
+    return record;
+}
+
+void LoggerClass::setArgument(Record& record, int index, const String& value) {
+    // texts are stored back to back and truncated once the buffer is full
+    int offset = record.textLength < kMaxTextLength ? record.textLength : kMaxTextLength - 1;
+    int length = value.length();
+    if (length > kMaxTextLength - 1 - offset) {
+        length = kMaxTextLength - 1 - offset;
+    }
+
+    memcpy(record.text + offset, value.c_str(), length);
+    record.text[offset + length] = 0;
+    record.textLength = offset + length + 1;
+
+    record.arguments[index] = offset;
+    record.textArguments |= 1 << index;
+}
+
+void LoggerClass::setArgument(Record& record, int index, const TimeInterval& value) {
+    bool isNever = value == TimeInterval::neverInThePast() || value == TimeInterval::neverInTheFuture();
+    record.arguments[index] = uintptr_t(isNever ? kNeverSeconds : value.seconds());
+}
+
+static void printTimeInterval(int32_t seconds, Print& output) {
+    if (seconds == kNeverSeconds) {
+        output.print(F("never"));
+        return;
+    }
+
+    char buffer[TimeInterval::kMaxFormattedLength];
+    TimeInterval::withSeconds(seconds).format(buffer, sizeof(buffer));
+    output.print(buffer);
+}
+
+// pads to the width given, with the sign ahead of zeros as printf does
+static void printNumber(uint32_t magnitude, bool isNegative, uint8_t base, int width, char padding, Print& output) {
+    int length = isNegative ? 2 : 1;
+    for (uint32_t value = magnitude; value >= base; value /= base) {
+        ++length;
+    }
+
+    if (padding == ' ') {
+        for (; width > length; --width) {
+            output.print(' ');
+        }
+    }
+    if (isNegative) {
+        output.print('-');
+    }
+    for (; width > length; --width) {
+        output.print('0');
+    }
+    output.print(magnitude, base);
+}
+
+static void printString(const char* str, Print& output) {
+    // pgm_read_byte works for both RAM and flash addresses
+    for (char ch = pgm_read_byte(str); ch != 0; ch = pgm_read_byte(++str)) {
+        output.print(ch);
+    }
+}
+
+const LoggerClass::Record* LoggerClass::record(uint32_t sequence) const {
+    // unsigned arithmetic keeps working when the sequence numbers wrap around
+    uint32_t age = _nextSequence - sequence;
+    if (age == 0 || age > _count) {
+        return nullptr;
+    }
+
+    return &_records[(_head + _count - age) % kCapacity];
+}
+
+const __FlashStringHelper* LoggerClass::moduleName(uint8_t module) {
+    return module < kNumLogModules ? flashStringAt(kModuleNames, module) : F("?");
+}
+
+void LoggerClass::format(const Record& record, Print& output) const {
+    output.print(record.timestamp);
+    output.print(' ');
+    output.print(char(pgm_read_byte(kLevelTags + record.level)));
+    output.print(F(" ["));
+    output.print(moduleName(record.module));
+    output.print(F("] "));
+    formatMessage(record, output);
+}
+
+void LoggerClass::formatMessage(const Record& record, Print& output) const {
+    const char* ptr = record.format;
+    int index = 0;
+
+    for (char ch = pgm_read_byte(ptr); ch != 0; ch = pgm_read_byte(++ptr)) {
+        if (ch != '%') {
+            output.print(ch);
+            continue;
+        }
+
+        char spec = pgm_read_byte(++ptr);
+        if (spec == '%') {
+            output.print('%');
+            continue;
+        }
+
+        // flags and width, only the zero flag is honoured
+        char padding = ' ';
+        for (; spec == '-' || spec == '+' || spec == ' ' || spec == '#' || spec == '0'; spec = pgm_read_byte(++ptr)) {
+            if (spec == '0') {
+                padding = '0';
+            }
+        }
+        int width = 0;
+        for (; spec >= '0' && spec <= '9'; spec = pgm_read_byte(++ptr)) {
+            width = width * 10 + (spec - '0');
+        }
+
+        if (spec == 0) {
+            break;
+        }
+        if (index >= kMaxArguments) {
+            continue;
+        }
+
+        uintptr_t value = record.arguments[index];
+        bool isText = record.textArguments & (1 << index);
+        ++index;
+
+        switch (spec) {
+            case 'd': {
+                int32_t number = int32_t(value);
+                printNumber(number < 0 ? 0 - uint32_t(number) : uint32_t(number), number < 0, DEC, width, padding, output);
+                break;
+            }
+            case 'u': printNumber(uint32_t(value), false, DEC, width, padding, output); break;
+            case 'x': printNumber(uint32_t(value), false, HEX, width, padding, output); break;
+            case 'c': output.print(char(value)); break;
+            case 'T': printTimeInterval(int32_t(value), output); break;
+            case 's':
+                if (isText) {
+                    output.print(record.text + value);
+                }
+                else if (value) {
+                    printString(reinterpret_cast<const char*>(value), output);
+                }
+                break;
+            default: break;
+        }
+    }
+}
+
+uint32_t LoggerClass::print(Print& output, uint32_t cursor, uint32_t until) const {
+    uint32_t first = firstSequence();
+    if (int32_t(first - cursor) > 0) {
+        output.print(F("[Logger] "));
+        output.print(first - cursor);
+        output.print(F(" records dropped\n"));
+        cursor = first;
+    }
+
+    for (; int32_t(until - cursor) > 0; ++cursor) {
+        const Record* r = record(cursor);
+        if (!r) {
+            break;
+        }
+        format(*r, output);
+    }
+
+    return cursor;
+}
+
+void LoggerClass::drain(Print& output) {
+    _drainCursor = print(output, _drainCursor, _nextSequence);
+}
@@ -0,0 +1,186 @@
+#ifndef __logger_h
+#define __logger_h
+
+#include <pgmspace.h>
+#include <stdint.h>
+#include <WString.h>
+#include "time.h"
+
+class Print;
+
+typedef enum {
+    kLogLevelNone = 0,
+    kLogLevelError,
+    kLogLevelWarning,
+    kLogLevelInfo,
+    kLogLevelDebug
+} LogLevel;
+
+typedef enum {
+    kLogModuleMain = 0,
+    kLogModuleClock,
+    kLogModuleDDNS,
+    kLogModuleDutyCycleManager,
+    kLogModuleEEPROMSchema,
+    kLogModuleIrrigator,
+    kLogModuleMoistureLogger,
+    kLogModulePersistence,
+    kLogModuleThingTweet,
+    kLogModuleWebService,
+
+    kNumLogModules
+} LogModule;
+
+// Compile-time log levels, overridable per module, e.g. -DLOG_LEVEL_Clock=kLogLevelDebug.
+// Statements above the level of their module are compiled out together with their
+// format strings.
+#ifndef LOG_LEVEL_DEFAULT
+#if DEBUG
+#define LOG_LEVEL_DEFAULT kLogLevelDebug
+#else
+#define LOG_LEVEL_DEFAULT kLogLevelWarning
+#endif
+#endif
+
+#ifndef LOG_LEVEL_Main
+#define LOG_LEVEL_Main LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_Clock
+#define LOG_LEVEL_Clock LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_DDNS
+#define LOG_LEVEL_DDNS LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_DutyCycleManager
+#define LOG_LEVEL_DutyCycleManager LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_EEPROMSchema
+#define LOG_LEVEL_EEPROMSchema LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_Irrigator
+#define LOG_LEVEL_Irrigator LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_MoistureLogger
+#define LOG_LEVEL_MoistureLogger LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_Persistence
+#define LOG_LEVEL_Persistence LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_ThingTweet
+#define LOG_LEVEL_ThingTweet LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_WebService
+#define LOG_LEVEL_WebService LOG_LEVEL_DEFAULT
+#endif
+
+// Records the format string (kept in flash, its address identifies the statement)
+// and the raw arguments; formatting happens when the log is drained.
+// Supported conversions:
+//   %d %u %x %c  integers of at most 32 bits, %d %u %x with a width and
+//                the 0 flag as in printf, e.g. %08x; other flags are ignored
+//   %s           const char* or F() strings that outlive the record,
+//                or String, whose contents are copied into the record
+//   %T           TimeInterval, rendered as "1h 2m 3s"
+//   %%           a literal percent sign
+#define LOG_AT(__module__, __level__, __format__, ...) \
+    do { \
+        if ((__level__) <= LOG_LEVEL_##__module__) { \
+            Logger.log(kLogModule##__module__, (__level__), PSTR(__format__), ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_ERROR(__module__, __format__, ...) LOG_AT(__module__, kLogLevelError, __format__, ##__VA_ARGS__)
+#define LOG_WARNING(__module__, __format__, ...) LOG_AT(__module__, kLogLevelWarning, __format__, ##__VA_ARGS__)
+#define LOG_INFO(__module__, __format__, ...) LOG_AT(__module__, kLogLevelInfo, __format__, ##__VA_ARGS__)
+#define LOG_DEBUG(__module__, __format__, ...) LOG_AT(__module__, kLogLevelDebug, __format__, ##__VA_ARGS__)
+
+class LoggerClass {
+public:
+    static const int kMaxArguments = 6;
+    static const int kMaxTextLength = 24;
+    static const int kCapacity = 32;
+
+    struct Record {
+        uint32_t timestamp;
+        PGM_P format;
+        uint8_t module;
+        uint8_t level;
+        uint8_t textLength;
+        // bit i is set if argument i is an offset into text
+        uint8_t textArguments;
+        uintptr_t arguments[kMaxArguments];
+        char text[kMaxTextLength];
+    };
+
+public:
+    LoggerClass();
+
+    template <typename... Args>
+    void log(uint8_t module, uint8_t level, PGM_P format, const Args&... args) {
+        static_assert(sizeof...(Args) <= kMaxArguments, "too many log arguments");
+        Record& record = beginRecord(module, level, format);
+        capture(record, 0, args...);
+    }
+
+    // Every record gets a sequence number; records are kept until the ring wraps
+    // around, so any number of readers can follow the log with their own cursor.
+    uint32_t firstSequence() const { return _nextSequence - _count; }
+    uint32_t nextSequence() const { return _nextSequence; }
+
+    // nullptr if the record has already been overwritten or not yet written
+    const Record* record(uint32_t sequence) const;
+
+    // prints "timestamp level [module] message"
+    void format(const Record& record, Print& output) const;
+    // prints the message only
+    void formatMessage(const Record& record, Print& output) const;
+
+    static const __FlashStringHelper* moduleName(uint8_t module);
+
+    // Prints the records from cursor up to, but not including, until and returns the
+    // cursor to resume from. Records overwritten since the cursor are reported as
+    // dropped.
+    uint32_t print(Print& output, uint32_t cursor, uint32_t until) const;
+
+    // writes out the records logged since the last drain
+    void drain(Print& output);
+
+private:
+    Record& beginRecord(uint8_t module, uint8_t level, PGM_P format);
+
+    void capture(Record& record, int index) {}
+
+    template <typename T, typename... Rest>
+    void capture(Record& record, int index, const T& value, const Rest&... rest) {
+        setArgument(record, index, value);
+        capture(record, index + 1, rest...);
+    }
+
+    template <typename T>
+    void setArgument(Record& record, int index, const T& value) {
+        static_assert(sizeof(T) <= sizeof(uintptr_t), "log arguments must fit in a word");
+        record.arguments[index] = uintptr_t(value);
+    }
+
+    void setArgument(Record& record, int index, const char* value) {
+        record.arguments[index] = reinterpret_cast<uintptr_t>(value);
+    }
+
+    void setArgument(Record& record, int index, const __FlashStringHelper* value) {
+        record.arguments[index] = reinterpret_cast<uintptr_t>(value);
+    }
+
+    void setArgument(Record& record, int index, const String& value);
+    void setArgument(Record& record, int index, const TimeInterval& value);
+
+private:
+    Record _records[kCapacity];
+    uint16_t _head;
+    uint16_t _count;
+    uint32_t _nextSequence;
+    uint32_t _drainCursor;
+};
+
+extern LoggerClass Logger;
+
+#endif // __logger_h
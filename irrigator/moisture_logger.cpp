@@ -4,12 +4,16 @@
 #include "clock.h"
 #include "common.h"
 #include "http_response.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "str_builder.h"
+#include "string_ext.h"
 
-static const char kIOTPlotterAPIKey[] = "*";
-static const char kIOTPlotterFeedID[] = "*";
-static const char kThingspeakAPIKey[] = "*";
-static const char kThingspeakChannelID[] = "*";
-static const TimeInterval kSampleInterval = TimeInterval::withSeconds(60 * 15);
+static const char kIOTPlotterAPIKey[] PROGMEM = "*";
+static const char kIOTPlotterFeedID[] PROGMEM = "*";
+static const char kThingspeakAPIKey[] PROGMEM = "*";
+static const char kThingspeakChannelID[] PROGMEM = "*";
+static constexpr TimeInterval kSampleInterval = 15_min;
 
 MoistureLoggerClass MoistureLogger;
 
@@ -18,13 +22,18 @@ MoistureLoggerClass::MoistureLoggerClass():
     pinMode(pinA[0], INPUT);
 }
 
+TimeInterval MoistureLoggerClass::timeIntervalTillNextSample() const {
+    CumulativeTime dueTime = SchedulerClass::nextSlot(_lastSampleCumulativeTime, kSampleInterval);
+    return dueTime.timeIntervalSince(Clock.cumulativeTimeSnapshot());
+}
+
 int MoistureLoggerClass::sample() {
-    DeviceTime localTime = Clock.deviceTime();
-    CumulativeTime dueTime = _lastSampleCumulativeTime + kSampleInterval;
+    const DeviceTime& localTime = Clock.deviceTimeSnapshot();
+    CumulativeTime dueTime = SchedulerClass::nextSlot(_lastSampleCumulativeTime, kSampleInterval);
     int32_t seconds = dueTime.timeIntervalSince(Clock.cumulativeTimeFromDeviceTime(localTime)).seconds();
 
     if (seconds > 0) {
-        LOG(F("[MoistureLogger] not sampling.\n"));
+        LOG_DEBUG(MoistureLogger, "not sampling.\n");
         return -1;
     }
 
@@ -37,10 +46,7 @@ int MoistureLoggerClass::sample() {
         _maxValue = value;
     }
 
-    LOG(String(F("[MoistureLogger] moisture = ")) + String(value) + 
-        F(" (min: ") + String(_minValue) + 
-        F(", max: ") + String(_maxValue) + 
-        F(")\n"));
+    LOG_INFO(MoistureLogger, "moisture = %d (min: %d, max: %d)\n", value, _minValue, _maxValue);
 
     _lastSampleCumulativeTime = Clock.cumulativeTimeFromDeviceTime(localTime);
 
@@ -49,13 +55,17 @@ int MoistureLoggerClass::sample() {
 
 bool MoistureLoggerClass::submitToIOTPlotter(int value) {
     if (WiFi.status() != WL_CONNECTED) {
-        LOG(F("failed: not connected\n"));
+        LOG_WARNING(MoistureLogger, "failed: not connected\n");
         return false;
     }
 
+    ProfilerScope scope(kProbeCallIOTPlotter);
+
     IPAddress logServerIP;
-    if (!WiFi.hostByName("iotplotter.com", logServerIP)) {
-        LOG(F("[MoistureLogger] error: cannot resolve log server host\n"));
+    char host[kMaxHostNameLength];
+    copyFromFlash(host, sizeof(host), F("iotplotter.com"));
+    if (!WiFi.hostByName(host, logServerIP)) {
+        LOG_ERROR(MoistureLogger, "cannot resolve log server host\n");
         return false;
     }
 
@@ -68,22 +78,37 @@ bool MoistureLoggerClass::submitToIOTPlotter(int value) {
     }
 
     if (!client.connected()) {
-        LOG(F("[MoistureLogger] error: cannot connect to log server\n"));
+        LOG_ERROR(MoistureLogger, "cannot connect to log server\n");
         return false;
     }
 
-    String payload("{\"data\":{\"moisture\":[{\"value\":" + String(value) + "}]}}");
-
-    String header;
-    header += String(F("POST /api/v2/feed/")) + String(kIOTPlotterFeedID) + F("HTTP/1.1\n");
-    header += F("Connection: Close\n");
-    header += String(F("api-key: ")) + String(kIOTPlotterAPIKey) + F("\n");
-    header += F("Content-Type: application/x-www-form-urlencoded\n");
-    header += F("Host: iotplotter.com\n");
-    header += String(F("Content-Length: ")) + String(payload.length()) + F("\n\n");
+    char payloadBuffer[64];
+    StrBuilder payload(payloadBuffer, sizeof(payloadBuffer));
+    payload.append(F("{\"data\":{\"moisture\":[{\"value\":"));
+    payload.append(int32_t(value));
+    payload.append(F("}]}}"));
+
+    char headerBuffer[192];
+    StrBuilder header(headerBuffer, sizeof(headerBuffer));
+    header.append(F("POST /api/v2/feed/"));
+    header.append(FPSTR(kIOTPlotterFeedID));
+    header.append(F("HTTP/1.1\n"));
+    header.append(F("Connection: Close\n"));
+    header.append(F("api-key: "));
+    header.append(FPSTR(kIOTPlotterAPIKey));
+    header.append(F("\n"));
+    header.append(F("Content-Type: application/x-www-form-urlencoded\n"));
+    header.append(F("Host: iotplotter.com\n"));
+    header.append(F("Content-Length: "));
+    header.append(uint32_t(payload.length()));
+    header.append(F("\n\n"));
+
+    if (header.isOverflowed() || payload.isOverflowed()) {
+        LOG_ERROR(MoistureLogger, "request too long\n");
+        return false;
+    }
 
-    LOG(header);
-    LOG(payload + "\n\n----\n\n");
+    LOG_DEBUG(MoistureLogger, "posting %u byte header, %u byte payload\n", header.length(), payload.length());
 
     client.write(header.c_str(), header.length());
     client.write(payload.c_str(), payload.length());
@@ -96,13 +121,13 @@ bool MoistureLoggerClass::submitToIOTPlotter(int value) {
     }
 
     if (!client.available()) {
-        LOG(F("[MoistureLogger] error: connection reset\n"));
+        LOG_ERROR(MoistureLogger, "connection reset\n");
         return false;
     }
 
     HTTPResponse response(client);
     if (response.statusCode() != 200) {
-        LOG(String(F("[MoistureLogger] error: server returned ")) + String(response.statusCode()) + F("\n"));
+        LOG_ERROR(MoistureLogger, "server returned %d\n", response.statusCode());
         return false;
     }
 
@@ -113,13 +138,17 @@ bool MoistureLoggerClass::submitToIOTPlotter(int value) {
 
 bool MoistureLoggerClass::submitToThingspeak(int value) {
     if (WiFi.status() != WL_CONNECTED) {
-        LOG(F("failed: not connected\n"));
+        LOG_WARNING(MoistureLogger, "failed: not connected\n");
         return false;
     }
 
+    ProfilerScope scope(kProbeCallThingSpeak);
+
     IPAddress logServerIP;
-    if (!WiFi.hostByName("api.thingspeak.com", logServerIP)) {
-        LOG(F("[MoistureLogger] error: cannot resolve log server host\n"));
+    char host[kMaxHostNameLength];
+    copyFromFlash(host, sizeof(host), F("api.thingspeak.com"));
+    if (!WiFi.hostByName(host, logServerIP)) {
+        LOG_ERROR(MoistureLogger, "cannot resolve log server host\n");
         return false;
     }
 
@@ -132,21 +161,28 @@ bool MoistureLoggerClass::submitToThingspeak(int value) {
     }
 
     if (!client.connected()) {
-        LOG(F("[MoistureLogger] error: cannot connect to log server\n"));
+        LOG_ERROR(MoistureLogger, "cannot connect to log server\n");
+        return false;
+    }
+
+    char buffer[192];
+    StrBuilder request(buffer, sizeof(buffer));
+    request.append(F("GET https://api.thingspeak.com/update?api_key="));
+    request.append(FPSTR(kThingspeakAPIKey));
+    request.append(F("&channel_id="));
+    request.append(FPSTR(kThingspeakChannelID));
+    request.append(F("&field1="));
+    request.append(int32_t(value));
+    request.append(F(" HTTP/1.1\r\n"));
+    request.append(F("Host: api.thingspeak.com\r\n"));
+    request.append(F("Connection: keep-alive\r\n\r\n"));
+
+    if (request.isOverflowed()) {
+        LOG_ERROR(MoistureLogger, "request too long\n");
         return false;
     }
 
-    String request(F("GET https://api.thingspeak.com/update?api_key="));
-    request += kThingspeakAPIKey;
-    request += F("&channel_id=");
-    request += kThingspeakChannelID;
-    request += F("&field1=");
-    request += String(value);
-    request += F(" HTTP/1.1\r\n");
-    request += F("Host: api.thingspeak.com\r\n");
-    request += F("Connection: keep-alive\r\n\r\n");
-  
-    client.print(request);
+    client.write(request.c_str(), request.length());
     client.flush();
 
     interval = 10;
@@ -156,13 +192,13 @@ bool MoistureLoggerClass::submitToThingspeak(int value) {
     }
 
     if (!client.available()) {
-        LOG(F("[MoistureLogger] error: connection reset\n"));
+        LOG_ERROR(MoistureLogger, "connection reset\n");
         return false;
     }
 
     HTTPResponse response(client);
     if (response.statusCode() != 200) {
-        LOG(String(F("[MoistureLogger] error: server returned ")) + String(response.statusCode()) + F("\n"));
+        LOG_ERROR(MoistureLogger, "server returned %d\n", response.statusCode());
         return false;
     }
 
@@ -7,6 +7,7 @@ class MoistureLoggerClass {
 public:
     MoistureLoggerClass();
     int sample();
+    TimeInterval timeIntervalTillNextSample() const;
     bool submitToIOTPlotter(int value);
     bool submitToThingspeak(int value);
 
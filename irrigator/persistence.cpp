@@ -0,0 +1,112 @@
+#include "persistence.h"
+
+#include <Arduino.h>
+#include "clock.h"
+#include "common.h"
+#include "eeprom_schema.h"
+#include "scheduler.h"
+#include "string_ext.h"
+
+#if DEBUG
+static constexpr TimeInterval kCommitDeferralInterval = 10_s;
+#else
+static constexpr TimeInterval kCommitDeferralInterval = 5_min;
+#endif
+
+static constexpr char kSubsystemNames[] PROGMEM = "main\0" "Clock\0" "DutyCycleManager\0" "WiFi\0" "FlowMeter";
+
+static_assert(flashStringCount(kSubsystemNames, sizeof(kSubsystemNames)) == PersistenceClass::kNumSubsystems,
+              "every persistence subsystem needs a name");
+
+PersistenceClass Persistence;
+
+PersistenceClass::PersistenceClass():
+    _commitDeadline(DeviceTime::distantPast()),
+    _commitCount(0),
+    _failedCommitCount(0),
+    _lastCommitLatencyMicros(0),
+    _maxCommitLatencyMicros(0) {
+    for (int i = 0; i < kNumSubsystems; ++i) {
+        _dirtyRanges[i].first = -1;
+        _dirtyRanges[i].last = -1;
+    }
+}
+
+void PersistenceClass::markDirty(Subsystem subsystem, int firstAddress, int lastAddress) {
+    if (!isDirty()) {
+        _commitDeadline = Clock.deviceTime() + kCommitDeferralInterval;
+    }
+
+    DirtyRange& range = _dirtyRanges[subsystem];
+    if (range.first < 0 || firstAddress < range.first) {
+        range.first = firstAddress;
+    }
+    if (range.last < 0 || lastAddress > range.last) {
+        range.last = lastAddress;
+    }
+}
+
+bool PersistenceClass::isDirty() const {
+    for (int i = 0; i < kNumSubsystems; ++i) {
+        if (_dirtyRanges[i].first >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PersistenceClass::commit() {
+    if (!isDirty()) {
+        return true;
+    }
+
+    for (int i = 0; i < kNumSubsystems; ++i) {
+        if (_dirtyRanges[i].first >= 0) {
+            LOG_DEBUG(Persistence, "committing %s [%d-%d]\n",
+                flashStringAt(kSubsystemNames, i), _dirtyRanges[i].first, _dirtyRanges[i].last);
+        }
+    }
+
+    unsigned long startTime = micros();
+    bool success = EEPROMSchema.commit();
+    _lastCommitLatencyMicros = micros() - startTime;
+
+    if (_lastCommitLatencyMicros > _maxCommitLatencyMicros) {
+        _maxCommitLatencyMicros = _lastCommitLatencyMicros;
+    }
+
+    if (!success) {
+        // keep the ranges dirty and retry at the next deadline
+        ++_failedCommitCount;
+        _commitDeadline = Clock.deviceTime() + kCommitDeferralInterval;
+        LOG_ERROR(Persistence, "EEPROM commit failed\n");
+        return false;
+    }
+
+    ++_commitCount;
+    for (int i = 0; i < kNumSubsystems; ++i) {
+        _dirtyRanges[i].first = -1;
+        _dirtyRanges[i].last = -1;
+    }
+    _commitDeadline = DeviceTime::distantPast();
+
+    LOG_DEBUG(Persistence, "commit #%u took %uus\n", _commitCount, _lastCommitLatencyMicros);
+
+    return true;
+}
+
+bool PersistenceClass::commitIfDue() {
+    if (!isDirty() || Clock.deviceTime() < _commitDeadline) {
+        return true;
+    }
+
+    return commit();
+}
+
+TimeInterval PersistenceClass::timeIntervalTillCommit() const {
+    if (!isDirty()) {
+        return SchedulerClass::noDeadline();
+    }
+
+    return _commitDeadline.timeIntervalSince(Clock.deviceTimeSnapshot());
+}
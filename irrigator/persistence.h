@@ -0,0 +1,72 @@
+#ifndef __persistence_h
+#define __persistence_h
+
+#include <EEPROM.h>
+#include <string.h>
+#include "time.h"
+
+class PersistenceClass {
+public:
+    typedef enum {
+        kSubsystemMain = 0,
+        kSubsystemClock,
+        kSubsystemDutyCycleManager,
+        kSubsystemWiFi,
+        kSubsystemFlowMeter,
+
+        kNumSubsystems
+    } Subsystem;
+
+    typedef enum {
+        // coalesced with other writes, committed by the deadline at the latest
+        kDeferrable = 0,
+        // committed immediately along with everything pending
+        kCritical
+    } Durability;
+
+public:
+    PersistenceClass();
+
+    template <typename T>
+    void put(Subsystem subsystem, int address, const T& value, Durability durability = kDeferrable) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        if (memcmp(EEPROM.getConstDataPtr() + address, bytes, sizeof(T)) != 0) {
+            EEPROM.put(address, value);
+            markDirty(subsystem, address, address + sizeof(T) - 1);
+        }
+
+        if (durability == kCritical) {
+            commit();
+        }
+    }
+
+    void markDirty(Subsystem subsystem, int firstAddress, int lastAddress);
+    bool isDirty() const;
+
+    bool commit();
+    bool commitIfDue();
+    TimeInterval timeIntervalTillCommit() const;
+
+    uint32_t commitCount() const { return _commitCount; }
+    uint32_t failedCommitCount() const { return _failedCommitCount; }
+    unsigned long lastCommitLatencyMicros() const { return _lastCommitLatencyMicros; }
+    unsigned long maxCommitLatencyMicros() const { return _maxCommitLatencyMicros; }
+
+private:
+    struct DirtyRange {
+        int16_t first;
+        int16_t last;
+    };
+
+private:
+    DirtyRange _dirtyRanges[kNumSubsystems];
+    DeviceTime _commitDeadline;
+    uint32_t _commitCount;
+    uint32_t _failedCommitCount;
+    unsigned long _lastCommitLatencyMicros;
+    unsigned long _maxCommitLatencyMicros;
+};
+
+extern PersistenceClass Persistence;
+
+#endif // __persistence_h
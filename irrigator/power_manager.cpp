@@ -0,0 +1,112 @@
+#include "power_manager.h"
+
+#include <ESP8266WiFi.h>
+#include "clock.h"
+#include "common.h"
+#include "irrigator.h"
+#include "persistence.h"
+#include "string_ext.h"
+
+// below this the radio would barely get to sleep before the next wake-up
+static constexpr TimeInterval kMinLightSleepInterval = 3_s;
+static constexpr TimeInterval kMinDeepSleepInterval = 10_min;
+// beacons skipped in light sleep, at the usual 100ms beacon interval
+static const uint8_t kLightSleepListenInterval = 3;
+
+// The RTC timer that ends a deep sleep is off by up to a few percent, and the
+// board has to boot and reconnect afterwards, so it wakes up early by this much
+// plus kDeepSleepDriftMargin of the interval.
+static constexpr TimeInterval kDeepSleepWakeMargin = 5_s;
+static const int kDeepSleepDriftMarginPercent = 3;
+
+static const uint32_t kModemSleepPollIntervalMillis = 10;
+static const uint32_t kLightSleepPollIntervalMillis = 100;
+
+static constexpr char kModeNames[] PROGMEM = "modem\0" "light\0" "deep";
+
+static_assert(flashStringCount(kModeNames, sizeof(kModeNames)) == kNumPowerModes,
+              "every power mode needs a name");
+
+PowerManagerClass PowerManager;
+
+PowerManagerClass::PowerManagerClass(): _isDeepSleepAllowed(false), _mode(kPowerModeModemSleep) {
+    for (int i = 0; i < kNumPowerModes; ++i) {
+        _millisInMode[i] = 0;
+    }
+}
+
+void PowerManagerClass::begin(bool isDeepSleepAllowed) {
+    _isDeepSleepAllowed = isDeepSleepAllowed;
+    _mode = kPowerModeLightSleep;
+    enter(kPowerModeModemSleep);
+}
+
+const __FlashStringHelper* PowerManagerClass::modeName(PowerMode mode) {
+    return flashStringAt(kModeNames, mode);
+}
+
+PowerMode PowerManagerClass::modeForInterval(const TimeInterval& interval) const {
+    if (_isDeepSleepAllowed && interval >= kMinDeepSleepInterval && !Irrigator.isBusy()) {
+        return kPowerModeDeepSleep;
+    }
+
+    if (interval >= kMinLightSleepInterval) {
+        return kPowerModeLightSleep;
+    }
+
+    return kPowerModeModemSleep;
+}
+
+void PowerManagerClass::enter(PowerMode mode) {
+    if (mode == _mode || mode == kPowerModeDeepSleep) {
+        return;
+    }
+
+    // the SDK enters either sleep by itself whenever the CPU idles in delay()
+    if (mode == kPowerModeLightSleep) {
+        WiFi.setSleepMode(WIFI_LIGHT_SLEEP, kLightSleepListenInterval);
+    }
+    else {
+        WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+    }
+
+    _mode = mode;
+}
+
+uint32_t PowerManagerClass::wakePollIntervalMillis() const {
+    // waking up more often than the listen interval would keep the CPU from sleeping
+    return _mode == kPowerModeLightSleep ? kLightSleepPollIntervalMillis : kModemSleepPollIntervalMillis;
+}
+
+void PowerManagerClass::account(uint32_t sleptMillis) {
+    _millisInMode[_mode] += sleptMillis;
+}
+
+void PowerManagerClass::deepSleep(const TimeInterval& interval) {
+    TimeInterval duration = interval - kDeepSleepWakeMargin -
+        TimeInterval::withTicks(interval._ticks * kDeepSleepDriftMarginPercent / 100);
+
+    uint64_t durationMicros = uint64_t(duration.milliseconds()) * 1000;
+    if (durationMicros > ESP.deepSleepMax()) {
+        durationMicros = ESP.deepSleepMax();
+        duration = TimeInterval::withMilliseconds(durationMicros / 1000);
+    }
+
+    Clock.saveForDeepSleep(duration);
+    if (!Persistence.commit()) {
+        LOG_ERROR(Main, "not sleeping: EEPROM commit failed\n");
+        return;
+    }
+
+    LOG_INFO(Main, "deep sleep for %T\n", duration);
+    #if DEBUG
+    Logger.drain(Serial);
+    #endif
+
+    // disconnect(true) would also switch the station off and clear its stored
+    // config; powering the radio down is all that is needed
+    WiFi.disconnect();
+    WiFi.forceSleepBegin();
+    delay(1);
+    ESP.deepSleep(durationMicros);
+}
@@ -0,0 +1,57 @@
+#ifndef __power_manager_h
+#define __power_manager_h
+
+#include <WString.h>
+#include <stdint.h>
+#include "time.h"
+
+typedef enum {
+    // the radio sleeps between beacons, the CPU keeps running
+    kPowerModeModemSleep = 0,
+    // the CPU sleeps as well while idle, the station stays associated
+    kPowerModeLightSleep,
+    // everything but the RTC is off, the board resets to wake up
+    kPowerModeDeepSleep,
+
+    kNumPowerModes
+} PowerMode;
+
+// Picks the deepest sleep that still wakes the board in time for the next
+// deadline. Deep sleep makes the web server unreachable and needs GPIO16 wired
+// to RST, so it has to be enabled explicitly, e.g. on solar powered sites.
+//
+// Deep sleep needs 10 minutes without a deadline. The moisture samples and the
+// DDNS updates both run every 15 minutes, on the same slots (see
+// SchedulerClass::nextSlot), which leaves room for it between them. The hourly
+// uptime save still costs one of those stretches an hour: the commit it defers
+// is due 5 minutes later, which splits the stretch in two.
+class PowerManagerClass {
+public:
+    PowerManagerClass();
+
+    void begin(bool isDeepSleepAllowed);
+
+    PowerMode modeForInterval(const TimeInterval& interval) const;
+
+    // configures the radio for sleeping in mode until the next loop
+    void enter(PowerMode mode);
+    // how often wake conditions are checked while sleeping in the current mode
+    uint32_t wakePollIntervalMillis() const;
+    void account(uint32_t sleptMillis);
+
+    // Saves the state that has to survive, then sleeps until shortly before the
+    // deadline. Only returns if deep sleep is not possible right now.
+    void deepSleep(const TimeInterval& interval);
+
+    uint64_t millisInMode(PowerMode mode) const { return _millisInMode[mode]; }
+    static const __FlashStringHelper* modeName(PowerMode mode);
+
+private:
+    bool _isDeepSleepAllowed;
+    PowerMode _mode;
+    uint64_t _millisInMode[kNumPowerModes];
+};
+
+extern PowerManagerClass PowerManager;
+
+#endif // __power_manager_h
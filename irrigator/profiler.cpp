@@ -0,0 +1,154 @@
+#include "profiler.h"
+
+#include <Print.h>
+#include <string.h>
+#include "string_ext.h"
+
+static constexpr char kProbeNames[] PROGMEM =
+    "loop\0" "wifi\0" "ddns\0" "serve\0" "clock_sync\0" "valve_queue\0" "duty_cycle\0" "moisture_sample\0"
+    "moisture_submit\0" "eeprom_commit\0" "syslog\0"
+    "ipify\0" "noip\0" "iotplotter\0" "thingspeak\0" "thingtweet\0" "wifi_connect";
+
+static_assert(flashStringCount(kProbeNames, sizeof(kProbeNames)) == kNumProbes,
+              "every probe needs a name");
+
+static const uint32_t kFirstBucketBoundMicros = 64;
+
+ProfilerClass Profiler;
+
+ProfilerClass::ProfilerClass(): _loopStartMicros(0), _lapStartMicros(0), _lastLap(kProbeLoop), _overheadCycles(0) {
+    memset(_stats, 0, sizeof(_stats));
+}
+
+static int bucketIndex(uint32_t micros) {
+    if (micros <= kFirstBucketBoundMicros) {
+        return 0;
+    }
+
+    // ceil(log2(micros)), two bits per bucket above 2^6
+    int bits = 32 - __builtin_clz(micros - 1);
+    int index = (bits - 5) / 2;
+    return index < ProfilerClass::kNumBuckets ? index : ProfilerClass::kNumBuckets - 1;
+}
+
+void ProfilerClass::record(ProfilerProbe probe, uint32_t micros) {
+    ProbeStats& s = _stats[probe];
+
+    ++s.count;
+    s.lastMicros = micros;
+    if (micros > s.maxMicros) {
+        s.maxMicros = micros;
+    }
+    s.totalMicros += micros;
+    ++s.buckets[bucketIndex(micros)];
+}
+
+const __FlashStringHelper* ProfilerClass::probeName(ProfilerProbe probe) {
+    return flashStringAt(kProbeNames, probe);
+}
+
+uint32_t ProfilerClass::overheadMicros() const {
+    return _overheadCycles / ESP.getCpuFreqMHz();
+}
+
+static void printSeconds(Print& output, uint64_t micros) {
+    uint32_t fraction = micros % 1000000;
+
+    output.print(uint32_t(micros / 1000000));
+    output.print('.');
+    for (uint32_t digit = 100000; digit > 1 && fraction < digit; digit /= 10) {
+        output.print('0');
+    }
+    output.print(fraction);
+}
+
+// prints "<name><suffix>{stage="<probe>"", leaving the label set open
+static void printSeries(Print& output, const __FlashStringHelper* name,
+                        const __FlashStringHelper* suffix, ProfilerProbe probe) {
+    output.print(name);
+    output.print(suffix);
+    output.print(probe < kFirstCallProbe ? F("{stage=\"") : F("{call=\""));
+    output.print(ProfilerClass::probeName(probe));
+    output.print('"');
+}
+
+// the exposition format requires \n line endings, println would add \r\n
+static void printValue(Print& output, uint32_t value) {
+    output.print(F("} "));
+    output.print(value);
+    output.print('\n');
+}
+
+static void printSecondsValue(Print& output, uint64_t micros) {
+    output.print(F("} "));
+    printSeconds(output, micros);
+    output.print('\n');
+}
+
+static void writeProbeHistograms(Print& output, const __FlashStringHelper* name,
+                                 int firstProbe, int lastProbe) {
+    output.print(F("# TYPE "));
+    output.print(name);
+    output.print(F(" histogram\n"));
+
+    for (int i = firstProbe; i <= lastProbe; ++i) {
+        ProfilerProbe probe = ProfilerProbe(i);
+        const ProfilerClass::ProbeStats& s = Profiler.stats(probe);
+        uint32_t cumulativeCount = 0;
+        uint32_t bound = kFirstBucketBoundMicros;
+
+        for (int b = 0; b < ProfilerClass::kNumBuckets; ++b, bound *= 4) {
+            cumulativeCount += s.buckets[b];
+            printSeries(output, name, F("_bucket"), probe);
+            output.print(F(",le=\""));
+            if (b < ProfilerClass::kNumBuckets - 1) {
+                printSeconds(output, bound);
+            }
+            else {
+                output.print(F("+Inf"));
+            }
+            output.print('"');
+            printValue(output, cumulativeCount);
+        }
+
+        printSeries(output, name, F("_sum"), probe);
+        printSecondsValue(output, s.totalMicros);
+        printSeries(output, name, F("_count"), probe);
+        printValue(output, s.count);
+    }
+}
+
+static void writeProbeGauges(Print& output, const __FlashStringHelper* name,
+                             uint32_t ProfilerClass::ProbeStats::*field) {
+    output.print(F("# TYPE "));
+    output.print(name);
+    output.print(F(" gauge\n"));
+
+    for (int i = 0; i < kNumProbes; ++i) {
+        ProfilerProbe probe = ProfilerProbe(i);
+        printSeries(output, name, F(""), probe);
+        printSecondsValue(output, Profiler.stats(probe).*field);
+    }
+}
+
+void ProfilerClass::writeMetrics(Print& output) const {
+    writeProbeHistograms(output, F("irrigator_stage_duration_seconds"), kProbeLoop, kFirstCallProbe - 1);
+    writeProbeHistograms(output, F("irrigator_call_duration_seconds"), kFirstCallProbe, kNumProbes - 1);
+    writeProbeGauges(output, F("irrigator_duration_last_seconds"), &ProbeStats::lastMicros);
+    writeProbeGauges(output, F("irrigator_duration_max_seconds"), &ProbeStats::maxMicros);
+
+    output.print(F("# TYPE irrigator_heap_free_bytes gauge\nirrigator_heap_free_bytes "));
+    output.print(ESP.getFreeHeap());
+    output.print(F("\n# TYPE irrigator_heap_max_block_bytes gauge\nirrigator_heap_max_block_bytes "));
+    output.print(ESP.getMaxFreeBlockSize());
+
+    uint32_t overhead = overheadMicros();
+    uint64_t loopMicros = _stats[kProbeLoop].totalMicros;
+    output.print(F("\n# TYPE irrigator_profiler_overhead_seconds_total counter\n"
+                   "irrigator_profiler_overhead_seconds_total "));
+    printSeconds(output, overhead);
+    // relative to the time spent in the loop, in parts per million
+    output.print(F("\n# TYPE irrigator_profiler_overhead_ppm gauge\nirrigator_profiler_overhead_ppm "));
+    output.print(loopMicros > 0 ? uint32_t(uint64_t(overhead) * 1000000 / loopMicros) : 0);
+    output.print('\n');
+}
@@ -0,0 +1,116 @@
+#ifndef __profiler_h
+#define __profiler_h
+
+#include <Arduino.h>
+#include <stdint.h>
+
+class Print;
+
+typedef enum {
+    // the whole loop, without the trailing delay
+    kProbeLoop = 0,
+
+    // loop stages, in order
+    kProbeWiFi,
+    kProbeDDNS,
+    kProbeServe,
+    kProbeClockSync,
+    kProbeValveQueue,
+    kProbeDutyCycle,
+    kProbeMoistureSample,
+    kProbeMoistureSubmit,
+    kProbeEEPROMCommit,
+    kProbeSyslog,
+
+    // outbound HTTP calls, from name resolution to the parsed response
+    kProbeCallIpify,
+    kProbeCallNoIP,
+    kProbeCallIOTPlotter,
+    kProbeCallThingSpeak,
+    kProbeCallThingTweet,
+    // from WiFi.begin() to the station getting its IP address
+    kProbeCallWiFiConnect,
+
+    kNumProbes,
+    kFirstCallProbe = kProbeCallIpify
+} ProfilerProbe;
+
+// Collects latency statistics for the loop stages and the outbound calls. Stages
+// are timed with laps: each lap records the time since the previous one, so a
+// stage costs a single micros() call. The profiler measures its own cost in CPU
+// cycles and reports it relative to the loop time.
+class ProfilerClass {
+public:
+    // upper bounds of the histogram buckets are 64us * 4^i, the last one is +Inf
+    static const int kNumBuckets = 10;
+
+    struct ProbeStats {
+        uint32_t count;
+        uint32_t lastMicros;
+        uint32_t maxMicros;
+        uint64_t totalMicros;
+        uint32_t buckets[kNumBuckets];
+    };
+
+public:
+    ProfilerClass();
+
+    void beginLoop() {
+        uint32_t startCycles = ESP.getCycleCount();
+        _loopStartMicros = _lapStartMicros = micros();
+        _lastLap = kProbeLoop;
+        _overheadCycles += ESP.getCycleCount() - startCycles;
+    }
+
+    // records the time since the previous lap unless the stage was skipped
+    void lap(ProfilerProbe probe, bool didRun = true) {
+        uint32_t startCycles = ESP.getCycleCount();
+        uint32_t now = micros();
+        if (didRun) {
+            record(probe, now - _lapStartMicros);
+        }
+        _lapStartMicros = now;
+        _lastLap = probe;
+        _overheadCycles += ESP.getCycleCount() - startCycles;
+    }
+
+    void endLoop() {
+        uint32_t startCycles = ESP.getCycleCount();
+        record(kProbeLoop, micros() - _loopStartMicros);
+        _overheadCycles += ESP.getCycleCount() - startCycles;
+    }
+
+    void record(ProfilerProbe probe, uint32_t micros);
+
+    const ProbeStats& stats(ProfilerProbe probe) const { return _stats[probe]; }
+    // the last stage completed in the current loop, kProbeLoop before the first one
+    ProfilerProbe lastLap() const { return _lastLap; }
+    static const __FlashStringHelper* probeName(ProfilerProbe probe);
+
+    uint32_t overheadMicros() const;
+
+    // writes every statistic in the Prometheus text exposition format
+    void writeMetrics(Print& output) const;
+
+private:
+    ProbeStats _stats[kNumProbes];
+    uint32_t _loopStartMicros;
+    uint32_t _lapStartMicros;
+    ProfilerProbe _lastLap;
+    uint64_t _overheadCycles;
+};
+
+extern ProfilerClass Profiler;
+
+// times the enclosing scope, e.g. an outbound call with several exit paths
+class ProfilerScope {
+public:
+    ProfilerScope(ProfilerProbe probe): _probe(probe), _startMicros(micros()) {}
+    ~ProfilerScope() { Profiler.record(_probe, micros() - _startMicros); }
+
+private:
+    ProfilerProbe _probe;
+    uint32_t _startMicros;
+};
+
+#endif // __profiler_h
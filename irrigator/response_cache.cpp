@@ -0,0 +1,58 @@
+#include "response_cache.h"
+
+#include <Print.h>
+#include "str_builder.h"
+
+ResponseCacheClass ResponseCache;
+
+ResponseCacheClass::ResponseCacheClass():
+    _nextEvicted(0),
+    _hitCount(0),
+    _missCount(0) {
+    for (int i = 0; i < kMaxEntryCount; ++i) {
+        _entries[i].isValid = false;
+    }
+}
+
+ResponseCacheClass::Entry* ResponseCacheClass::entryFor(uint8_t key) {
+    for (int i = 0; i < kMaxEntryCount; ++i) {
+        if (_entries[i].isValid && _entries[i].key == key) {
+            return &_entries[i];
+        }
+    }
+
+    for (int i = 0; i < kMaxEntryCount; ++i) {
+        if (!_entries[i].isValid) {
+            return &_entries[i];
+        }
+    }
+
+    // all taken by other keys, they are replaced in turn
+    Entry* entry = &_entries[_nextEvicted];
+    _nextEvicted = (_nextEvicted + 1) % kMaxEntryCount;
+    return entry;
+}
+
+void ResponseCacheClass::write(uint8_t key, uint32_t generation, Renderer render, Print& output) {
+    Entry* entry = entryFor(key);
+    if (entry->isValid && entry->key == key && entry->generation == generation) {
+        ++_hitCount;
+        output.write(reinterpret_cast<const uint8_t*>(entry->data), entry->length);
+        return;
+    }
+
+    ++_missCount;
+    StrBuilder fragment(entry->data, sizeof(entry->data));
+    render(fragment);
+    if (fragment.isOverflowed()) {
+        entry->isValid = false;
+        render(output);
+        return;
+    }
+
+    entry->key = key;
+    entry->isValid = true;
+    entry->generation = generation;
+    entry->length = fragment.length();
+    output.write(reinterpret_cast<const uint8_t*>(entry->data), entry->length);
+}
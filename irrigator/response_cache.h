@@ -0,0 +1,53 @@
+#ifndef __response_cache_h
+#define __response_cache_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Print;
+
+// Rendered response fragments, keyed by route, kept until the state they were
+// rendered from changes. The owner of that state counts its changes in a
+// generation; a fragment from an older generation is rendered again. What
+// changes with time alone has to be written around the cached fragment.
+class ResponseCacheClass {
+public:
+    // only the status is cached so far, raise this for another route
+    static const int kMaxEntryCount = 1;
+    static const size_t kEntryCapacity = 512;
+
+    typedef void (*Renderer)(Print& output);
+
+public:
+    ResponseCacheClass();
+
+    // Writes the fragment kept for key to output, rendering it first unless it
+    // was rendered at this generation already. A fragment that does not fit is
+    // rendered straight to output every time.
+    void write(uint8_t key, uint32_t generation, Renderer render, Print& output);
+
+    uint32_t hitCount() const { return _hitCount; }
+    uint32_t missCount() const { return _missCount; }
+
+private:
+    struct Entry {
+        uint8_t key;
+        bool isValid;
+        uint32_t generation;
+        uint16_t length;
+        char data[kEntryCapacity];
+    };
+
+    Entry* entryFor(uint8_t key);
+
+private:
+    Entry _entries[kMaxEntryCount];
+    int _nextEvicted;
+
+    uint32_t _hitCount;
+    uint32_t _missCount;
+};
+
+extern ResponseCacheClass ResponseCache;
+
+#endif // __response_cache_h
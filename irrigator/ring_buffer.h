@@ -0,0 +1,100 @@
+#ifndef __ring_buffer_h
+#define __ring_buffer_h
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+// A FIFO queue of up to Capacity elements stored inline. Pushing onto a full
+// buffer fails and returns false, it never overwrites the oldest element.
+template <typename T, size_t Capacity>
+class RingBuffer {
+public:
+    RingBuffer(): _head(0), _size(0) {}
+
+    RingBuffer(const RingBuffer& other): _head(0), _size(0) {
+        for (size_t i = 0; i < other.size(); ++i) {
+            push(other[i]);
+        }
+    }
+
+    RingBuffer(RingBuffer&& other): _head(0), _size(0) {
+        while (!other.isEmpty()) {
+            push(std::move(other.front()));
+            other.pop();
+        }
+    }
+
+    ~RingBuffer() { clear(); }
+
+    RingBuffer& operator=(const RingBuffer& other) {
+        if (this != &other) {
+            clear();
+            for (size_t i = 0; i < other.size(); ++i) {
+                push(other[i]);
+            }
+        }
+        return *this;
+    }
+
+    RingBuffer& operator=(RingBuffer&& other) {
+        if (this != &other) {
+            clear();
+            while (!other.isEmpty()) {
+                push(std::move(other.front()));
+                other.pop();
+            }
+        }
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    static constexpr size_t capacity() { return Capacity; }
+    bool isEmpty() const { return _size == 0; }
+    bool isFull() const { return _size == Capacity; }
+
+    // elements counted from the oldest one
+    T& operator[](size_t index) { return slot((_head + index) % Capacity); }
+    const T& operator[](size_t index) const { return slot((_head + index) % Capacity); }
+
+    T& front() { return slot(_head); }
+    const T& front() const { return slot(_head); }
+
+    bool push(const T& item) { return emplace(item); }
+    bool push(T&& item) { return emplace(std::move(item)); }
+
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        if (isFull()) {
+            return false;
+        }
+        new (&slot((_head + _size) % Capacity)) T(std::forward<Args>(args)...);
+        ++_size;
+        return true;
+    }
+
+    void pop() {
+        slot(_head).~T();
+        _head = (_head + 1) % Capacity;
+        --_size;
+    }
+
+    void clear() {
+        while (_size > 0) {
+            pop();
+        }
+        _head = 0;
+    }
+
+private:
+    T& slot(size_t index) { return reinterpret_cast<T*>(_storage)[index]; }
+    const T& slot(size_t index) const { return reinterpret_cast<const T*>(_storage)[index]; }
+
+private:
+    alignas(T) uint8_t _storage[Capacity * sizeof(T)];
+    size_t _head;
+    size_t _size;
+};
+
+#endif // __ring_buffer_h
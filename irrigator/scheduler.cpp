@@ -0,0 +1,112 @@
+#include "scheduler.h"
+
+#include <Arduino.h>
+#include "clock.h"
+#include "common.h"
+#include "power_manager.h"
+
+// Upper bound of a sleep, well within the budget of the loop watchdog
+static constexpr TimeInterval kMaxSleepInterval = 10_s;
+// WiFiServer has no accept callback to wait on, so wake conditions are polled.
+// delay() hands the CPU to the SDK in between, which lets the radio and, in
+// light sleep, the CPU sleep; see PowerManagerClass.
+
+SchedulerClass Scheduler;
+
+SchedulerClass::SchedulerClass():
+    _sourceCount(0),
+    _conditionCount(0),
+    _lastSleepMillis(0),
+    _totalSleepMillis(0),
+    _lastWakeReason(F("")) {
+}
+
+CumulativeTime SchedulerClass::nextSlot(const CumulativeTime& time, const TimeInterval& interval) {
+    if (time == CumulativeTime::distantPast()) {
+        return time;
+    }
+
+    int64_t ticks = time.timeIntervalSinceReferenceTime()._ticks;
+    return time + TimeInterval::withTicks(interval._ticks - ticks % interval._ticks);
+}
+
+void SchedulerClass::addDeadlineSource(const __FlashStringHelper* name, DeadlineSource source) {
+    if (_sourceCount == kMaxDeadlineSources) {
+        LOG_ERROR(Main, "too many deadline sources, ignoring %s\n", name);
+        return;
+    }
+
+    _sources[_sourceCount].name = name;
+    _sources[_sourceCount].source = source;
+    ++_sourceCount;
+}
+
+void SchedulerClass::addWakeCondition(const __FlashStringHelper* name, WakeCondition condition) {
+    if (_conditionCount == kMaxWakeConditions) {
+        LOG_ERROR(Main, "too many wake conditions, ignoring %s\n", name);
+        return;
+    }
+
+    _conditions[_conditionCount].name = name;
+    _conditions[_conditionCount].condition = condition;
+    ++_conditionCount;
+}
+
+const __FlashStringHelper* SchedulerClass::checkWakeConditions() const {
+    for (int i = 0; i < _conditionCount; ++i) {
+        if (_conditions[i].condition()) {
+            return _conditions[i].name;
+        }
+    }
+
+    return nullptr;
+}
+
+void SchedulerClass::sleep() {
+    TimeInterval interval = noDeadline();
+    _lastWakeReason = F("timeout");
+
+    for (int i = 0; i < _sourceCount; ++i) {
+        TimeInterval ti = _sources[i].source();
+        if (ti < interval) {
+            interval = ti;
+            _lastWakeReason = _sources[i].name;
+        }
+    }
+
+    // the sources measure from the snapshot taken at the start of the loop
+    interval -= Clock.deviceTime().timeIntervalSince(Clock.deviceTimeSnapshot());
+
+    PowerMode mode = PowerManager.modeForInterval(interval);
+    if (mode == kPowerModeDeepSleep) {
+        PowerManager.deepSleep(interval);
+        mode = kPowerModeLightSleep;
+    }
+    PowerManager.enter(mode);
+
+    if (interval > kMaxSleepInterval) {
+        interval = kMaxSleepInterval;
+        _lastWakeReason = F("timeout");
+    }
+
+    uint32_t startMillis = millis();
+    int32_t sleepMillis = interval.milliseconds();
+    uint32_t pollIntervalMillis = PowerManager.wakePollIntervalMillis();
+
+    while (int32_t(millis() - startMillis) < sleepMillis) {
+        const __FlashStringHelper* reason = checkWakeConditions();
+        if (reason) {
+            _lastWakeReason = reason;
+            break;
+        }
+
+        uint32_t remainingMillis = sleepMillis - (millis() - startMillis);
+        delay(remainingMillis < pollIntervalMillis ? remainingMillis : pollIntervalMillis);
+    }
+
+    _lastSleepMillis = millis() - startMillis;
+    _totalSleepMillis += _lastSleepMillis;
+    PowerManager.account(_lastSleepMillis);
+
+    LOG_DEBUG(Main, "slept %ums, woken by %s\n", _lastSleepMillis, _lastWakeReason);
+}
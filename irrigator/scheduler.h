@@ -0,0 +1,72 @@
+#ifndef __scheduler_h
+#define __scheduler_h
+
+#include <WString.h>
+#include <stdint.h>
+#include "time.h"
+
+// Lets the loop sleep until something is due instead of polling at a fixed rate.
+// Each subsystem registers a deadline source, which tells how long it can wait
+// before its next piece of work; the time is taken relative to the clock snapshot
+// of the current loop iteration. Wake conditions are polled during the sleep and
+// cut it short, e.g. when a client connects to the web server.
+class SchedulerClass {
+public:
+    typedef TimeInterval (*DeadlineSource)();
+    typedef bool (*WakeCondition)();
+
+    static const int kMaxDeadlineSources = 8;
+    static const int kMaxWakeConditions = 4;
+
+public:
+    SchedulerClass();
+
+    // what a deadline source returns when it has nothing scheduled
+    static constexpr TimeInterval noDeadline() { return TimeInterval::withSeconds(INT32_MAX); }
+
+    // The first multiple of interval on the cumulative time scale after time.
+    // Periodic work that is due at these slots wakes the board at once instead
+    // of one piece at a time, which leaves idle stretches long enough for deep
+    // sleep. A time in the distant past stays there, i.e. the work is due now.
+    static CumulativeTime nextSlot(const CumulativeTime& time, const TimeInterval& interval);
+
+    void addDeadlineSource(const __FlashStringHelper* name, DeadlineSource source);
+    void addWakeCondition(const __FlashStringHelper* name, WakeCondition condition);
+
+    // Sleeps until the earliest deadline or wake condition, whichever comes first.
+    // The power manager picks the sleep mode from the time left.
+    void sleep();
+
+    uint32_t lastSleepMillis() const { return _lastSleepMillis; }
+    uint64_t totalSleepMillis() const { return _totalSleepMillis; }
+    // the deadline source or wake condition that ended the last sleep
+    const __FlashStringHelper* lastWakeReason() const { return _lastWakeReason; }
+
+private:
+    struct DeadlineEntry {
+        const __FlashStringHelper* name;
+        DeadlineSource source;
+    };
+
+    struct WakeEntry {
+        const __FlashStringHelper* name;
+        WakeCondition condition;
+    };
+
+private:
+    const __FlashStringHelper* checkWakeConditions() const;
+
+private:
+    DeadlineEntry _sources[kMaxDeadlineSources];
+    int _sourceCount;
+    WakeEntry _conditions[kMaxWakeConditions];
+    int _conditionCount;
+
+    uint32_t _lastSleepMillis;
+    uint64_t _totalSleepMillis;
+    const __FlashStringHelper* _lastWakeReason;
+};
+
+extern SchedulerClass Scheduler;
+
+#endif // __scheduler_h
@@ -0,0 +1,211 @@
+#ifndef __small_map_h
+#define __small_map_h
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+
+template <typename K> struct SmallMapHash;
+
+// Fibonacci hashing, which spreads small consecutive keys such as enum values
+#define SMALL_MAP_INTEGER_HASH(__type__) \
+    template <> struct SmallMapHash<__type__> { \
+        uint32_t operator()(__type__ key) const { return uint32_t(key) * 2654435761u; } \
+    };
+
+SMALL_MAP_INTEGER_HASH(uint8_t)
+SMALL_MAP_INTEGER_HASH(uint16_t)
+SMALL_MAP_INTEGER_HASH(uint32_t)
+SMALL_MAP_INTEGER_HASH(int)
+
+#undef SMALL_MAP_INTEGER_HASH
+
+// FNV-1a over NUL terminated strings, compared by content
+template <> struct SmallMapHash<const char*> {
+    uint32_t operator()(const char* key) const {
+        uint32_t hash = 2166136261u;
+        for (; *key; ++key) {
+            hash = (hash ^ uint8_t(*key)) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+template <typename K> struct SmallMapEqual {
+    bool operator()(const K& a, const K& b) const { return a == b; }
+};
+
+template <> struct SmallMapEqual<const char*> {
+    bool operator()(const char* a, const char* b) const { return strcmp(a, b) == 0; }
+};
+
+// An open addressing hash map with linear probing and up to Capacity entries,
+// stored inline. Capacity has to be a power of two; one slot always stays free
+// so that probes terminate. Removal shifts the following entries back instead
+// of leaving tombstones, so lookups do not degrade over time.
+template <typename K, typename V, size_t Capacity, typename Hash = SmallMapHash<K>, typename Equal = SmallMapEqual<K>>
+class SmallMap {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "the capacity must be a power of two");
+
+public:
+    struct Entry {
+        K key;
+        V value;
+    };
+
+public:
+    SmallMap(): _size(0) {
+        memset(_isOccupied, 0, sizeof(_isOccupied));
+    }
+
+    SmallMap(const SmallMap& other): SmallMap() {
+        other.forEach([this](const K& key, const V& value) { put(key, value); });
+    }
+
+    SmallMap(SmallMap&& other): SmallMap() {
+        moveFrom(other);
+    }
+
+    ~SmallMap() { clear(); }
+
+    SmallMap& operator=(const SmallMap& other) {
+        if (this != &other) {
+            clear();
+            other.forEach([this](const K& key, const V& value) { put(key, value); });
+        }
+        return *this;
+    }
+
+    SmallMap& operator=(SmallMap&& other) {
+        if (this != &other) {
+            clear();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    static constexpr size_t capacity() { return Capacity - 1; }
+    bool isEmpty() const { return _size == 0; }
+    bool isFull() const { return _size == capacity(); }
+
+    V* find(const K& key) {
+        int index = indexOf(key);
+        return index >= 0 ? &entry(index).value : nullptr;
+    }
+
+    const V* find(const K& key) const {
+        int index = indexOf(key);
+        return index >= 0 ? &entry(index).value : nullptr;
+    }
+
+    // inserts or replaces, returns false if the key is new and the map is full
+    bool put(const K& key, const V& value) {
+        return put(key, V(value));
+    }
+
+    bool put(const K& key, V&& value) {
+        size_t index = probeStart(key);
+        for (; _isOccupied[index]; index = (index + 1) & kMask) {
+            if (Equal()(entry(index).key, key)) {
+                entry(index).value = std::move(value);
+                return true;
+            }
+        }
+
+        if (isFull()) {
+            return false;
+        }
+
+        new (&entry(index)) Entry{key, std::move(value)};
+        _isOccupied[index] = true;
+        ++_size;
+        return true;
+    }
+
+    bool remove(const K& key) {
+        int found = indexOf(key);
+        if (found < 0) {
+            return false;
+        }
+
+        // Move back every following entry of the cluster whose probe start does
+        // not lie cyclically within (hole, entry], so that it stays reachable.
+        size_t hole = found;
+        entry(hole).~Entry();
+        _isOccupied[hole] = false;
+        for (size_t index = (hole + 1) & kMask; _isOccupied[index]; index = (index + 1) & kMask) {
+            size_t start = probeStart(entry(index).key);
+            bool isReachable = hole <= index ? (hole < start && start <= index) : (hole < start || start <= index);
+            if (isReachable) {
+                continue;
+            }
+
+            new (&entry(hole)) Entry(std::move(entry(index)));
+            _isOccupied[hole] = true;
+            entry(index).~Entry();
+            _isOccupied[index] = false;
+            hole = index;
+        }
+
+        --_size;
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (_isOccupied[i]) {
+                entry(i).~Entry();
+                _isOccupied[i] = false;
+            }
+        }
+        _size = 0;
+    }
+
+    // calls f(key, value) for every entry, in no particular order
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (_isOccupied[i]) {
+                f(entry(i).key, entry(i).value);
+            }
+        }
+    }
+
+private:
+    static const size_t kMask = Capacity - 1;
+
+    size_t probeStart(const K& key) const { return Hash()(key) & kMask; }
+
+    int indexOf(const K& key) const {
+        for (size_t index = probeStart(key); _isOccupied[index]; index = (index + 1) & kMask) {
+            if (Equal()(entry(index).key, key)) {
+                return index;
+            }
+        }
+        return -1;
+    }
+
+    void moveFrom(SmallMap& other) {
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (other._isOccupied[i]) {
+                new (&entry(i)) Entry(std::move(other.entry(i)));
+                _isOccupied[i] = true;
+            }
+        }
+        _size = other._size;
+        other.clear();
+    }
+
+    Entry& entry(size_t index) { return reinterpret_cast<Entry*>(_storage)[index]; }
+    const Entry& entry(size_t index) const { return reinterpret_cast<const Entry*>(_storage)[index]; }
+
+private:
+    alignas(Entry) uint8_t _storage[Capacity * sizeof(Entry)];
+    bool _isOccupied[Capacity];
+    size_t _size;
+};
+
+#endif // __small_map_h
@@ -0,0 +1,162 @@
+// Generated by tools/embed_assets.py from the files in www/, do not edit.
+
+#include "static_assets.h"
+
+// index.html, 1935 bytes, 780 gzipped
+static const char kIndexHtmlPath[] PROGMEM = "/";
+static const char kIndexHtmlContentType[] PROGMEM = "text/html; charset=utf-8";
+static const char kIndexHtmlETag[] PROGMEM = "\"b2f993d33cc2f927\"";
+static const uint8_t kIndexHtmlData[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x55, 0x4d, 0x6f, 0xdb, 0x30,
+    0x0c, 0xbd, 0xe7, 0x57, 0x68, 0x3a, 0x0c, 0x1b, 0xd0, 0xd4, 0xc9, 0xba, 0xb5, 0x69, 0x67, 0x7b,
+    0x18, 0x9a, 0x1d, 0x06, 0xec, 0x0b, 0xeb, 0x50, 0x60, 0xa7, 0x42, 0x96, 0xe8, 0x58, 0xab, 0x2c,
+    0x79, 0xfa, 0x70, 0x9b, 0x7f, 0x3f, 0xca, 0xb1, 0x93, 0x66, 0xe8, 0x9c, 0x62, 0x27, 0xdb, 0xe4,
+    0x23, 0xf9, 0xf4, 0x44, 0xd2, 0xe9, 0xb3, 0xe5, 0xd7, 0xcb, 0x1f, 0x3f, 0xbf, 0x7d, 0x20, 0x95,
+    0xaf, 0x55, 0x3e, 0x49, 0xe3, 0x83, 0x28, 0xa6, 0x57, 0x19, 0x05, 0x4d, 0xa3, 0x01, 0x98, 0xc0,
+    0x47, 0x0d, 0x9e, 0x11, 0x5e, 0x31, 0xeb, 0xc0, 0x67, 0x34, 0xf8, 0x72, 0xba, 0xa0, 0x83, 0x59,
+    0xb3, 0x1a, 0x32, 0xda, 0x4a, 0xb8, 0x6b, 0x8c, 0xf5, 0x94, 0x70, 0xa3, 0x3d, 0x68, 0x84, 0xdd,
+    0x49, 0xe1, 0xab, 0x4c, 0x40, 0x2b, 0x39, 0x4c, 0xbb, 0x8f, 0x23, 0x22, 0xb5, 0xf4, 0x92, 0xa9,
+    0xa9, 0xe3, 0x4c, 0x41, 0x36, 0x8f, 0x49, 0xbc, 0xf4, 0x0a, 0xf2, 0x8f, 0xd6, 0xca, 0x15, 0xf3,
+    0xc6, 0xa6, 0xc9, 0xc6, 0x30, 0x49, 0x95, 0xd4, 0xb7, 0xc4, 0x82, 0xca, 0xa8, 0xf3, 0x6b, 0x05,
+    0xae, 0x02, 0xc0, 0xf4, 0x95, 0x85, 0x32, 0xa3, 0x49, 0x67, 0x3a, 0xe6, 0xce, 0xbd, 0x6b, 0xb3,
+    0x73, 0x58, 0x94, 0x33, 0x31, 0x3f, 0x2b, 0x80, 0xf3, 0x82, 0x9d, 0x43, 0xcc, 0xea, 0xb8, 0x95,
+    0x8d, 0x27, 0xce, 0x72, 0x04, 0xb3, 0xa6, 0x39, 0xfe, 0x15, 0x91, 0xaf, 0x0a, 0xfe, 0x66, 0x76,
+    0xc2, 0x17, 0x70, 0xf6, 0xfa, 0x74, 0x01, 0x8b, 0x05, 0x25, 0x02, 0x4a, 0xb0, 0x79, 0x9a, 0x6c,
+    0xf0, 0x18, 0x98, 0xf4, 0x47, 0x2e, 0x8c, 0x58, 0x47, 0x01, 0xe6, 0x3b, 0x6a, 0xe4, 0xca, 0x33,
+    0x1f, 0x1c, 0x42, 0xe6, 0xe8, 0x69, 0xf2, 0x4f, 0xcc, 0x79, 0xc2, 0xd7, 0x5c, 0x01, 0x81, 0x7b,
+    0xe0, 0xc1, 0x83, 0xb8, 0x20, 0xa9, 0x6b, 0x98, 0x26, 0x52, 0x64, 0x54, 0xa1, 0x7b, 0xda, 0xb9,
+    0x69, 0xfe, 0xbc, 0x02, 0xa5, 0x64, 0xf3, 0x16, 0x0b, 0xa1, 0x3b, 0x27, 0x6c, 0x65, 0xd2, 0xc2,
+    0xe6, 0x5f, 0xe0, 0x7e, 0xc8, 0x20, 0x02, 0x5c, 0xa0, 0x3c, 0x0f, 0xe2, 0x35, 0x3a, 0xff, 0x11,
+    0x9f, 0x26, 0x4d, 0x64, 0xd0, 0xc1, 0xc0, 0x5a, 0x63, 0x51, 0x17, 0x29, 0x04, 0xf4, 0x1e, 0x3c,
+    0x3e, 0x70, 0x2f, 0x8d, 0x46, 0x50, 0x69, 0x6c, 0x4d, 0xf0, 0xa2, 0x2a, 0x83, 0xd8, 0xc6, 0x38,
+    0x94, 0x90, 0x75, 0x3e, 0xd4, 0xc5, 0x02, 0xde, 0x67, 0x42, 0xf3, 0x54, 0xea, 0x26, 0x78, 0xe2,
+    0xd7, 0x0d, 0xde, 0xa4, 0x0b, 0x45, 0x2d, 0x11, 0xd5, 0x32, 0x15, 0xf0, 0xf3, 0x7b, 0xc4, 0x20,
+    0x24, 0x89, 0x89, 0x0e, 0xe7, 0xe3, 0x15, 0x88, 0xa0, 0xe0, 0xef, 0xa4, 0x1b, 0x76, 0xb4, 0x6f,
+    0x16, 0x01, 0x8a, 0xad, 0xb7, 0x15, 0x66, 0x07, 0x08, 0x04, 0x4d, 0xb4, 0xb9, 0xfb, 0x1f, 0x0a,
+    0x57, 0xfd, 0x2b, 0xd1, 0x5b, 0x9d, 0xf1, 0x82, 0x1e, 0xd6, 0xf2, 0xe8, 0x78, 0x9c, 0xd5, 0xe9,
+    0x0c, 0x79, 0x11, 0xd4, 0xd1, 0x68, 0xe1, 0x48, 0x69, 0x4d, 0x1d, 0x59, 0x90, 0x31, 0xa6, 0x43,
+    0xb9, 0x27, 0x52, 0x45, 0x5d, 0x6f, 0x24, 0xce, 0x8a, 0xc5, 0x70, 0x24, 0x7b, 0xd9, 0xb5, 0xc1,
+    0x60, 0x18, 0xe1, 0x59, 0x99, 0x60, 0x1d, 0xed, 0xee, 0x7e, 0x40, 0x23, 0xd3, 0xce, 0x3a, 0x4e,
+    0x0f, 0x3c, 0xd9, 0x05, 0x6c, 0x29, 0x26, 0xdb, 0x5e, 0x19, 0x3a, 0xea, 0x77, 0x80, 0x00, 0xbb,
+    0x8e, 0x62, 0xc3, 0xcc, 0x75, 0x76, 0x64, 0xfa, 0x99, 0xe9, 0xc0, 0x14, 0x0e, 0x7a, 0x5d, 0x33,
+    0x14, 0x27, 0x4d, 0x58, 0xde, 0xf7, 0x7d, 0xfe, 0xb0, 0x3f, 0x27, 0xa9, 0x90, 0x6d, 0x97, 0x10,
+    0x0b, 0xb6, 0xe0, 0x62, 0x4d, 0xb4, 0x44, 0x87, 0x87, 0xba, 0x51, 0xcc, 0xc3, 0xce, 0xdb, 0xcd,
+    0xec, 0x58, 0xd3, 0x72, 0x1c, 0x27, 0x87, 0x67, 0x02, 0xef, 0xa5, 0x5e, 0xb9, 0x6e, 0x39, 0x9d,
+    0xe4, 0xa9, 0x62, 0x05, 0xa8, 0xfd, 0xfe, 0xc1, 0x5b, 0xe0, 0xb7, 0x85, 0xb9, 0x1f, 0xf4, 0x92,
+    0xee, 0x06, 0x34, 0x2b, 0x14, 0x08, 0x94, 0xe9, 0x3a, 0x16, 0xeb, 0x87, 0xac, 0x4f, 0xa9, 0x43,
+    0x5d, 0x80, 0xa5, 0x3b, 0xee, 0x7d, 0xce, 0x04, 0xf3, 0xc7, 0x31, 0x5f, 0xc2, 0x66, 0x39, 0x20,
+    0xb5, 0xd1, 0xee, 0xd9, 0xa2, 0x30, 0x15, 0xce, 0xf6, 0x64, 0x19, 0x2c, 0x3b, 0x14, 0xd4, 0x43,
+    0x68, 0x8e, 0x67, 0x9f, 0xec, 0xb1, 0x2a, 0x55, 0xd7, 0xf3, 0x98, 0xe8, 0xda, 0xa8, 0x50, 0x8f,
+    0x35, 0x6e, 0xdb, 0x01, 0x68, 0xae, 0xc8, 0x8b, 0x19, 0x41, 0xe9, 0x88, 0x97, 0x35, 0x90, 0x82,
+    0x39, 0x10, 0x47, 0xc4, 0x57, 0x71, 0xb7, 0x6c, 0xca, 0x10, 0xe7, 0xa5, 0xc2, 0x05, 0x2f, 0xb1,
+    0x2d, 0x5c, 0xe7, 0xb1, 0x41, 0xbf, 0x8c, 0x35, 0x96, 0xa0, 0x64, 0x0b, 0x16, 0x04, 0x71, 0x86,
+    0x94, 0xcc, 0x5e, 0xec, 0x4b, 0x24, 0x06, 0xf7, 0x56, 0x25, 0xb5, 0xbf, 0x89, 0x46, 0x27, 0xf8,
+    0x7d, 0xd3, 0xa8, 0x35, 0xed, 0xa1, 0x23, 0x93, 0xd1, 0x17, 0x43, 0x4e, 0x34, 0x8f, 0x53, 0x6f,
+    0x34, 0x87, 0xee, 0x3c, 0x4f, 0xd3, 0xef, 0x11, 0xf9, 0xc8, 0x58, 0xf0, 0x56, 0xb6, 0x61, 0x29,
+    0x1f, 0xd8, 0x42, 0x8f, 0xce, 0x0c, 0xfe, 0xae, 0xfa, 0x5e, 0xde, 0xcd, 0x0f, 0x40, 0x83, 0xeb,
+    0x82, 0xee, 0x6d, 0x69, 0xb7, 0x76, 0xca, 0xac, 0xf6, 0xd7, 0x74, 0x9a, 0xf4, 0x3f, 0x99, 0x64,
+    0xf3, 0xfb, 0xfd, 0x03, 0x13, 0x3e, 0xc1, 0x74, 0x8f, 0x07, 0x00, 0x00,
+};
+
+// app.js, 2701 bytes, 983 gzipped
+static const char kAppJsPath[] PROGMEM = "/app.js";
+static const char kAppJsContentType[] PROGMEM = "application/javascript";
+static const char kAppJsETag[] PROGMEM = "\"2bc503c8e7468e88\"";
+static const uint8_t kAppJsData[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x56, 0xdb, 0x8e, 0xdb, 0x36,
+    0x10, 0x7d, 0xf7, 0x57, 0x4c, 0x81, 0x02, 0x94, 0x11, 0x97, 0x4e, 0x5e, 0x6b, 0x14, 0x41, 0xba,
+    0x70, 0x80, 0x00, 0x49, 0x13, 0x34, 0x45, 0x5f, 0x8a, 0xc2, 0x60, 0xa4, 0x91, 0xc5, 0x2e, 0x45,
+    0xba, 0x24, 0x65, 0xef, 0xa2, 0xd8, 0x7f, 0xef, 0xf0, 0x22, 0x46, 0xb2, 0xbd, 0x46, 0x62, 0x18,
+    0x92, 0xc8, 0x39, 0x67, 0x38, 0x9c, 0x39, 0x1c, 0x89, 0x0d, 0x0e, 0xc1, 0x79, 0x2b, 0x6b, 0xcf,
+    0x36, 0x8b, 0xc5, 0x7a, 0x0d, 0x6f, 0xa5, 0x52, 0x0e, 0x7c, 0x87, 0x70, 0x10, 0x7b, 0x04, 0xa9,
+    0xa1, 0xb5, 0xa6, 0x87, 0xb5, 0xf3, 0xc2, 0x0f, 0x8e, 0xff, 0xe3, 0x8c, 0xe6, 0xf0, 0x47, 0x31,
+    0x7b, 0x87, 0xaa, 0x05, 0xe9, 0x20, 0xd8, 0x65, 0x0d, 0x42, 0x37, 0x50, 0x8b, 0xba, 0xc3, 0x66,
+    0x05, 0xce, 0x04, 0x87, 0xbe, 0x23, 0x2b, 0xfd, 0x85, 0x52, 0xf4, 0x2c, 0x3c, 0xd4, 0xd6, 0x38,
+    0x87, 0x69, 0x0d, 0x8d, 0xfe, 0x64, 0xec, 0x3d, 0x18, 0x0d, 0x02, 0x2c, 0x1e, 0xa5, 0x93, 0x9e,
+    0x2f, 0x16, 0xed, 0xa0, 0x6b, 0x2f, 0x69, 0xf2, 0xc7, 0x4a, 0x36, 0x4b, 0xf8, 0x6f, 0x01, 0xf4,
+    0xb3, 0xe8, 0x07, 0xab, 0xa1, 0x31, 0xf5, 0xd0, 0xa3, 0xf6, 0x7c, 0x8f, 0x7e, 0xab, 0x30, 0x3c,
+    0xfe, 0xfa, 0xf8, 0xae, 0x09, 0xc0, 0xcd, 0xe2, 0x69, 0xc2, 0x55, 0xd2, 0x5b, 0x74, 0x55, 0x4f,
+    0x1b, 0x92, 0xe9, 0xf9, 0xcc, 0x53, 0xf5, 0x41, 0xf8, 0x8e, 0xb7, 0xca, 0x18, 0x3b, 0x45, 0xc1,
+    0x1a, 0x5e, 0xbd, 0x7c, 0xb9, 0x8c, 0xb7, 0x25, 0xf7, 0xe6, 0xad, 0x7c, 0xc0, 0xa6, 0x7a, 0x75,
+    0xe6, 0xdd, 0x75, 0xe6, 0xf4, 0xa7, 0x50, 0x47, 0xac, 0x8e, 0xe1, 0xba, 0x82, 0x06, 0x95, 0x3c,
+    0xa2, 0x8d, 0x1b, 0x8f, 0xb9, 0x1a, 0x57, 0xab, 0x8d, 0x76, 0x1e, 0x1c, 0x26, 0xde, 0x2f, 0xb4,
+    0x27, 0x16, 0x29, 0x6c, 0xc9, 0xc9, 0xe4, 0xc3, 0x56, 0x6a, 0x65, 0x34, 0xfe, 0x66, 0x1a, 0xac,
+    0xbc, 0x1d, 0x90, 0x56, 0x9a, 0xf2, 0xbc, 0x97, 0x7a, 0xef, 0x88, 0x98, 0x5d, 0xf0, 0x7f, 0x07,
+    0xb4, 0x8f, 0x9f, 0x51, 0xd1, 0x90, 0x22, 0x67, 0x7c, 0x84, 0xb0, 0x19, 0xd1, 0x0e, 0xfa, 0x06,
+    0x87, 0xac, 0x01, 0x1e, 0xf1, 0x23, 0x9f, 0x8b, 0x31, 0x44, 0xb6, 0x8e, 0x11, 0xae, 0x19, 0xbc,
+    0x80, 0xf8, 0xc4, 0xe3, 0x95, 0x46, 0x6c, 0xcd, 0x36, 0x73, 0x12, 0xa6, 0x1a, 0x38, 0x2e, 0xdd,
+    0x0e, 0xb5, 0xf8, 0xa2, 0xb0, 0xe1, 0x54, 0xff, 0xfa, 0x1e, 0x1b, 0xf2, 0x94, 0xd8, 0x79, 0xfe,
+    0x39, 0x66, 0x83, 0xae, 0xb6, 0xf2, 0x10, 0x03, 0xed, 0xc5, 0xc3, 0x7b, 0xd4, 0x7b, 0xdf, 0x85,
+    0xe0, 0x93, 0xe6, 0x26, 0xe6, 0x1d, 0x99, 0x77, 0x2a, 0xda, 0xbf, 0xc5, 0x19, 0xad, 0x3e, 0x60,
+    0x89, 0x62, 0x62, 0x79, 0x96, 0x3c, 0x58, 0x71, 0x8d, 0x99, 0xa7, 0x77, 0x6e, 0x24, 0x5e, 0xcf,
+    0xaa, 0x1e, 0xfa, 0x2f, 0x68, 0xa9, 0xb0, 0x1e, 0x1f, 0xfc, 0x5d, 0x2a, 0x6e, 0x71, 0x12, 0xaf,
+    0x39, 0xe5, 0x94, 0xfe, 0x6f, 0xcb, 0x36, 0x01, 0xc7, 0x8c, 0x07, 0xce, 0xf7, 0x04, 0x1a, 0x49,
+    0xb2, 0x85, 0x2a, 0xa7, 0x91, 0x84, 0x7e, 0xda, 0xf5, 0xe8, 0xd1, 0x8e, 0xca, 0xbc, 0x9e, 0x83,
+    0xa3, 0x51, 0x74, 0xc0, 0x8a, 0xe3, 0x7c, 0x8c, 0x72, 0x60, 0xd1, 0xb6, 0xeb, 0x55, 0x96, 0xda,
+    0x45, 0x5c, 0xdf, 0x4b, 0x7e, 0x2e, 0x93, 0xe5, 0x34, 0x5d, 0x24, 0x33, 0xbb, 0x2c, 0x80, 0xec,
+    0xec, 0x29, 0x5e, 0x51, 0x51, 0x3f, 0xfb, 0xba, 0x39, 0x6a, 0x3f, 0x27, 0xe9, 0x3b, 0x33, 0xf8,
+    0xd8, 0x6d, 0x5a, 0x89, 0xaa, 0x49, 0x8d, 0x27, 0xc5, 0x12, 0xfa, 0x92, 0xc2, 0xd6, 0x83, 0xa0,
+    0x16, 0xe5, 0x69, 0x74, 0x3b, 0xae, 0x37, 0x4a, 0x51, 0x68, 0x21, 0x8f, 0x14, 0x55, 0x6b, 0xec,
+    0x96, 0x1a, 0x5d, 0x55, 0x3a, 0x42, 0x15, 0x0c, 0x94, 0x5a, 0x08, 0x77, 0x6e, 0xb1, 0x37, 0xd4,
+    0x1c, 0x96, 0x1b, 0x78, 0x2a, 0x11, 0xc6, 0xdb, 0x78, 0xfc, 0xe9, 0xb8, 0x72, 0x71, 0x38, 0xa0,
+    0x6e, 0xee, 0x3a, 0xa9, 0x9a, 0x2a, 0xaf, 0x78, 0xa5, 0xcd, 0x54, 0xf3, 0x7e, 0x42, 0x0e, 0x94,
+    0x70, 0xfe, 0xa7, 0xfa, 0xb1, 0x56, 0x78, 0x91, 0x9e, 0x5c, 0xec, 0x80, 0xd8, 0x45, 0xc4, 0x66,
+    0x24, 0x69, 0xc2, 0xdd, 0x26, 0x05, 0xc4, 0x19, 0x49, 0x12, 0xc4, 0x52, 0xbc, 0x44, 0x19, 0x6b,
+    0x9a, 0xc1, 0xa3, 0x65, 0xd7, 0x5d, 0x4a, 0x8d, 0xb2, 0x36, 0x60, 0x14, 0xf8, 0x11, 0xa7, 0x62,
+    0x23, 0x87, 0xd1, 0x44, 0xde, 0x3a, 0xd9, 0x34, 0x18, 0xd4, 0xdf, 0x0a, 0xaa, 0xd9, 0xe6, 0x1a,
+    0xe4, 0x4c, 0x13, 0xee, 0x20, 0xf4, 0x79, 0xe4, 0x85, 0x16, 0x7e, 0xf3, 0xd5, 0x49, 0x96, 0x9a,
+    0x84, 0x0d, 0xaf, 0x81, 0xe5, 0xc7, 0x15, 0x30, 0xf8, 0x19, 0x18, 0xa1, 0xac, 0x4f, 0xc3, 0x25,
+    0x9d, 0xb1, 0x19, 0xa9, 0xc1, 0x03, 0x75, 0x1e, 0x3a, 0x78, 0x10, 0x0a, 0x43, 0x20, 0x36, 0xab,
+    0x5d, 0xc6, 0xa6, 0xfa, 0x5d, 0x51, 0x40, 0x7e, 0x15, 0xc8, 0xa0, 0x82, 0x8b, 0x17, 0x44, 0xe9,
+    0x66, 0x59, 0xb8, 0x74, 0x10, 0xfe, 0x92, 0x7f, 0x97, 0xb7, 0x45, 0x12, 0xca, 0xa4, 0x81, 0x23,
+    0x1e, 0xc2, 0x9b, 0xb7, 0x24, 0x3c, 0x8d, 0x4b, 0x65, 0xd2, 0xf0, 0xa2, 0x94, 0x6c, 0xbb, 0xfd,
+    0xf4, 0xfb, 0xc7, 0x0f, 0xe4, 0xa3, 0xef, 0xe9, 0xed, 0x4c, 0xfb, 0xa5, 0xed, 0x24, 0x2c, 0xcf,
+    0x73, 0x71, 0x7f, 0x55, 0x2b, 0x24, 0xb5, 0xe4, 0x99, 0x3d, 0x4d, 0xc1, 0x8b, 0x92, 0x55, 0xb6,
+    0x82, 0x20, 0xa4, 0x19, 0x28, 0x2a, 0xab, 0x8f, 0x4e, 0x7a, 0xb7, 0x02, 0x6a, 0xc8, 0x33, 0x73,
+    0x68, 0xd0, 0xa3, 0x75, 0xc9, 0x2e, 0xa5, 0xe1, 0x1e, 0x9d, 0x32, 0xfb, 0x33, 0x51, 0xa4, 0xc9,
+    0xdb, 0xaa, 0x28, 0x98, 0xb3, 0xfd, 0x7e, 0x8e, 0xf3, 0xf4, 0x4e, 0xaf, 0x8d, 0xa5, 0xc3, 0xed,
+    0x68, 0x3a, 0x05, 0x34, 0x5b, 0x90, 0x87, 0xf9, 0xb4, 0x71, 0x65, 0xdc, 0x55, 0x44, 0x98, 0x0f,
+    0x88, 0x65, 0xa9, 0x79, 0x38, 0x88, 0xe8, 0xa9, 0xc2, 0x6c, 0xfa, 0xf9, 0xc3, 0x96, 0xd1, 0xcc,
+    0xa9, 0x8d, 0xe8, 0x49, 0xed, 0xa9, 0x29, 0x1d, 0xa8, 0x6e, 0x33, 0xbd, 0x87, 0x7d, 0xff, 0x30,
+    0x1a, 0xb8, 0xb9, 0x9f, 0xda, 0xc2, 0xcf, 0x77, 0xd6, 0x9c, 0xe8, 0x23, 0xe8, 0x04, 0x5b, 0x6b,
+    0xa3, 0xc6, 0xe9, 0x48, 0xa1, 0xcd, 0x1f, 0x28, 0x54, 0x8a, 0x10, 0x65, 0xe1, 0x8f, 0x42, 0x29,
+    0x2e, 0x9e, 0xbe, 0xf6, 0xe0, 0xf4, 0x45, 0x53, 0xa0, 0x21, 0xce, 0x6a, 0xec, 0x3b, 0xd3, 0x78,
+    0x83, 0x2a, 0xf3, 0xb8, 0x16, 0x7e, 0x26, 0x5e, 0x0c, 0x21, 0x9c, 0x15, 0x26, 0xce, 0xdd, 0xae,
+    0xcb, 0x08, 0x39, 0x2b, 0xcb, 0x9d, 0xd0, 0xda, 0x78, 0x50, 0x46, 0x34, 0xb1, 0xe1, 0xa6, 0xe0,
+    0xb3, 0x54, 0x02, 0x85, 0xf7, 0xe8, 0x1c, 0x7d, 0x43, 0x8e, 0x41, 0x6e, 0x16, 0xff, 0x03, 0xd9,
+    0x20, 0x35, 0x31, 0x8d, 0x0a, 0x00, 0x00,
+};
+
+// style.css, 314 bytes, 201 gzipped
+static const char kStyleCssPath[] PROGMEM = "/style.css";
+static const char kStyleCssContentType[] PROGMEM = "text/css";
+static const char kStyleCssETag[] PROGMEM = "\"9e8f0d17beccba9e\"";
+static const uint8_t kStyleCssData[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x5d, 0x8e, 0xc1, 0x6e, 0x83, 0x30,
+    0x10, 0x44, 0xef, 0x7c, 0xc5, 0x2a, 0x9c, 0x89, 0x20, 0x2a, 0x17, 0x47, 0xf9, 0x92, 0x28, 0x07,
+    0x63, 0x2f, 0xe9, 0x4a, 0xd8, 0x6b, 0xad, 0x37, 0x2a, 0xa8, 0xca, 0xbf, 0x37, 0x80, 0x5b, 0x55,
+    0xd9, 0xe3, 0xcc, 0xdb, 0x99, 0x19, 0xd8, 0x2f, 0xf0, 0x5d, 0xc1, 0xeb, 0x46, 0x8e, 0xda, 0x8c,
+    0x36, 0xd0, 0xb4, 0x18, 0xc8, 0x36, 0xe6, 0x26, 0xa3, 0xd0, 0x78, 0xde, 0xcc, 0x60, 0xe7, 0xe6,
+    0x8b, 0xbc, 0x7e, 0x1a, 0xf8, 0x68, 0x31, 0xfc, 0x8a, 0x72, 0xa7, 0x68, 0xa0, 0x05, 0xfb, 0x50,
+    0xde, 0xb5, 0x64, 0xbd, 0xa7, 0x78, 0x5f, 0xc5, 0x6e, 0xe5, 0x9e, 0x55, 0x95, 0xd1, 0x29, 0x71,
+    0x2c, 0x35, 0x03, 0x8b, 0x47, 0x69, 0x94, 0x93, 0x81, 0x2e, 0xcd, 0x90, 0x79, 0x22, 0x0f, 0xb5,
+    0x73, 0xee, 0x3d, 0xe0, 0xd8, 0x63, 0x80, 0x76, 0x8b, 0x18, 0x59, 0x42, 0xf9, 0xff, 0x2b, 0xfd,
+    0x67, 0x53, 0x4c, 0x0f, 0xbd, 0xea, 0x92, 0xf0, 0x72, 0x50, 0x9c, 0xf5, 0x70, 0x2b, 0x70, 0x99,
+    0xdc, 0x97, 0x25, 0x3b, 0x17, 0x6d, 0x78, 0x71, 0x1e, 0xb3, 0x13, 0x4a, 0xeb, 0xb2, 0x77, 0xbc,
+    0x3b, 0x15, 0xbe, 0x46, 0x11, 0x96, 0x62, 0x3a, 0x9e, 0x58, 0x0c, 0xd4, 0x43, 0xbb, 0x95, 0xfe,
+    0x00, 0xe9, 0xe5, 0x71, 0x4b, 0x3a, 0x01, 0x00, 0x00,
+};
+
+static const StaticAsset kStaticAssets[] PROGMEM = {
+    { kIndexHtmlPath, kIndexHtmlContentType, kIndexHtmlETag, kIndexHtmlData, sizeof(kIndexHtmlData), false },
+    { kAppJsPath, kAppJsContentType, kAppJsETag, kAppJsData, sizeof(kAppJsData), true },
+    { kStyleCssPath, kStyleCssContentType, kStyleCssETag, kStyleCssData, sizeof(kStyleCssData), true },
+};
+
+const int kNumStaticAssets = sizeof(kStaticAssets) / sizeof(kStaticAssets[0]);
+
+StaticAsset staticAsset(int index) {
+    StaticAsset asset;
+    memcpy_P(&asset, &kStaticAssets[index], sizeof(asset));
+    return asset;
+}
@@ -0,0 +1,25 @@
+#ifndef __static_assets_h
+#define __static_assets_h
+
+#include <pgmspace.h>
+#include <stdint.h>
+
+// A file of the web UI. The sources are in www/, tools/embed_assets.py gzips them
+// into static_assets.cpp, which has to be regenerated whenever they change.
+struct StaticAsset {
+    // all in flash
+    PGM_P path;
+    PGM_P contentType;
+    // quoted, a hash of the content
+    PGM_P etag;
+    const uint8_t* data;
+    uint32_t length;
+    // Assets other than the page are linked with their hash in the query, so a
+    // cached copy never goes stale. The page itself is revalidated by its ETag.
+    bool isImmutable;
+};
+
+extern const int kNumStaticAssets;
+extern StaticAsset staticAsset(int index);
+
+#endif // __static_assets_h
@@ -0,0 +1,105 @@
+#ifndef __static_vector_h
+#define __static_vector_h
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+// A vector with its storage inline, up to Capacity elements. Nothing is ever
+// allocated: appending to a full vector fails and returns false.
+template <typename T, size_t Capacity>
+class StaticVector {
+public:
+    StaticVector(): _size(0) {}
+
+    StaticVector(const StaticVector& other): _size(0) {
+        for (const T& item : other) {
+            append(item);
+        }
+    }
+
+    StaticVector(StaticVector&& other): _size(0) {
+        for (T& item : other) {
+            append(std::move(item));
+        }
+        other.clear();
+    }
+
+    ~StaticVector() { clear(); }
+
+    StaticVector& operator=(const StaticVector& other) {
+        if (this != &other) {
+            clear();
+            for (const T& item : other) {
+                append(item);
+            }
+        }
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&& other) {
+        if (this != &other) {
+            clear();
+            for (T& item : other) {
+                append(std::move(item));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    static constexpr size_t capacity() { return Capacity; }
+    bool isEmpty() const { return _size == 0; }
+    bool isFull() const { return _size == Capacity; }
+
+    T& operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+
+    T* begin() { return data(); }
+    T* end() { return data() + _size; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + _size; }
+
+    bool append(const T& item) { return emplace(item); }
+    bool append(T&& item) { return emplace(std::move(item)); }
+
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        if (isFull()) {
+            return false;
+        }
+        new (data() + _size) T(std::forward<Args>(args)...);
+        ++_size;
+        return true;
+    }
+
+    void removeLast() {
+        data()[--_size].~T();
+    }
+
+    // removes the element at index, keeping the order of the rest
+    void remove(size_t index) {
+        for (size_t i = index; i + 1 < _size; ++i) {
+            data()[i] = std::move(data()[i + 1]);
+        }
+        removeLast();
+    }
+
+    void clear() {
+        while (_size > 0) {
+            removeLast();
+        }
+    }
+
+private:
+    T* data() { return reinterpret_cast<T*>(_storage); }
+    const T* data() const { return reinterpret_cast<const T*>(_storage); }
+
+private:
+    alignas(T) uint8_t _storage[Capacity * sizeof(T)];
+    size_t _size;
+};
+
+#endif // __static_vector_h
@@ -0,0 +1,89 @@
+#include "str_builder.h"
+
+#include <pgmspace.h>
+#include <string.h>
+
+StrBuilder::StrBuilder(char* buffer, size_t capacity):
+    _buffer(buffer),
+    _capacity(capacity),
+    _length(0),
+    _isOverflowed(capacity == 0) {
+    if (capacity > 0) {
+        _buffer[0] = 0;
+    }
+}
+
+size_t StrBuilder::write(uint8_t ch) {
+    return write(&ch, 1);
+}
+
+size_t StrBuilder::write(const uint8_t* buffer, size_t size) {
+    if (_capacity == 0) {
+        return 0;
+    }
+
+    // one byte stays reserved for the terminator
+    size_t available = _capacity - 1 - _length;
+    if (size > available) {
+        size = available;
+        _isOverflowed = true;
+    }
+
+    memcpy(_buffer + _length, buffer, size);
+    _length += size;
+    _buffer[_length] = 0;
+    return size;
+}
+
+StrBuilder& StrBuilder::append(char ch) {
+    write(uint8_t(ch));
+    return *this;
+}
+
+StrBuilder& StrBuilder::append(const char* str) {
+    write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+    return *this;
+}
+
+StrBuilder& StrBuilder::append(const StrView& str) {
+    write(reinterpret_cast<const uint8_t*>(str.data()), str.length());
+    return *this;
+}
+
+StrBuilder& StrBuilder::append(const __FlashStringHelper* str) {
+    PGM_P ptr = reinterpret_cast<PGM_P>(str);
+    size_t length = strlen_P(ptr);
+
+    if (_capacity == 0) {
+        return *this;
+    }
+
+    size_t available = _capacity - 1 - _length;
+    if (length > available) {
+        length = available;
+        _isOverflowed = true;
+    }
+
+    memcpy_P(_buffer + _length, ptr, length);
+    _length += length;
+    _buffer[_length] = 0;
+    return *this;
+}
+
+StrBuilder& StrBuilder::append(int32_t value) {
+    print(long(value));
+    return *this;
+}
+
+StrBuilder& StrBuilder::append(uint32_t value) {
+    print((unsigned long)value);
+    return *this;
+}
+
+void StrBuilder::clear() {
+    _length = 0;
+    _isOverflowed = _capacity == 0;
+    if (_capacity > 0) {
+        _buffer[0] = 0;
+    }
+}
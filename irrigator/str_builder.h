@@ -0,0 +1,41 @@
+#ifndef __str_builder_h
+#define __str_builder_h
+
+#include <Print.h>
+#include <WString.h>
+#include <stddef.h>
+#include "str_view.h"
+
+// Builds a NUL terminated string in a buffer provided by the caller. Whatever
+// does not fit is dropped and marks the builder as overflowed, so a truncated
+// result can be told apart from a complete one. Being a Print, it also takes
+// numbers and anything else that prints itself.
+class StrBuilder: public Print {
+public:
+    StrBuilder(char* buffer, size_t capacity);
+
+    size_t write(uint8_t ch) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    StrBuilder& append(char ch);
+    StrBuilder& append(const char* str);
+    StrBuilder& append(const StrView& str);
+    StrBuilder& append(const __FlashStringHelper* str);
+    StrBuilder& append(int32_t value);
+    StrBuilder& append(uint32_t value);
+
+    const char* c_str() const { return _buffer; }
+    size_t length() const { return _length; }
+    StrView view() const { return StrView(_buffer, _length); }
+    bool isOverflowed() const { return _isOverflowed; }
+
+    void clear();
+
+private:
+    char* _buffer;
+    size_t _capacity;
+    size_t _length;
+    bool _isOverflowed;
+};
+
+#endif // __str_builder_h
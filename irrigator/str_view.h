@@ -0,0 +1,190 @@
+#ifndef __str_view_h
+#define __str_view_h
+
+#include <WString.h>
+#include <pgmspace.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+// A borrowed, not necessarily NUL terminated run of characters. Views never
+// allocate; they must not outlive the buffer they point into.
+class StrView {
+public:
+    static const size_t npos = size_t(-1);
+
+public:
+    StrView(): _data(""), _length(0) {}
+    StrView(const char* data, size_t length): _data(data), _length(length) {}
+    StrView(const char* str): _data(str), _length(strlen(str)) {}
+    StrView(const String& str): _data(str.c_str()), _length(str.length()) {}
+
+    const char* data() const { return _data; }
+    size_t length() const { return _length; }
+    bool isEmpty() const { return _length == 0; }
+    char operator[](size_t index) const { return _data[index]; }
+
+    size_t find(char ch, size_t from = 0) const {
+        for (size_t i = from; i < _length; ++i) {
+            if (_data[i] == ch) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    size_t find(const StrView& needle, size_t from = 0) const {
+        if (needle._length == 0) {
+            return from <= _length ? from : npos;
+        }
+        for (size_t i = from; i + needle._length <= _length; ++i) {
+            if (_data[i] == needle._data[0] && memcmp(_data + i, needle._data, needle._length) == 0) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    size_t count(char ch) const {
+        size_t n = 0;
+        for (size_t i = 0; i < _length; ++i) {
+            n += _data[i] == ch;
+        }
+        return n;
+    }
+
+    StrView substr(size_t pos, size_t length = npos) const {
+        if (pos > _length) {
+            pos = _length;
+        }
+        if (length > _length - pos) {
+            length = _length - pos;
+        }
+        return StrView(_data + pos, length);
+    }
+
+    // Returns the part before the first separator and sets tail to the part
+    // after it. Without a separator the whole view is returned and tail is empty.
+    // Tail may be this view itself, which makes it easy to walk a list.
+    StrView split(const StrView& separator, StrView& tail) const {
+        size_t index = find(separator);
+        StrView head = substr(0, index);
+        tail = index == npos ? StrView() : substr(index + separator._length);
+        return head;
+    }
+
+    StrView trim() const {
+        size_t start = 0;
+        size_t end = _length;
+        while (start < end && isSpace(_data[start])) {
+            ++start;
+        }
+        while (end > start && isSpace(_data[end - 1])) {
+            --end;
+        }
+        return StrView(_data + start, end - start);
+    }
+
+    bool startsWith(const StrView& prefix) const {
+        return prefix._length <= _length && memcmp(_data, prefix._data, prefix._length) == 0;
+    }
+
+    bool startsWith(const __FlashStringHelper* prefix) const {
+        size_t length = strlen_P(reinterpret_cast<PGM_P>(prefix));
+        return length <= _length && memcmp_P(_data, reinterpret_cast<PGM_P>(prefix), length) == 0;
+    }
+
+    bool endsWith(const StrView& suffix) const {
+        return suffix._length <= _length &&
+            memcmp(_data + _length - suffix._length, suffix._data, suffix._length) == 0;
+    }
+
+    bool endsWith(const __FlashStringHelper* suffix) const {
+        size_t length = strlen_P(reinterpret_cast<PGM_P>(suffix));
+        return length <= _length && memcmp_P(_data + _length - length, reinterpret_cast<PGM_P>(suffix), length) == 0;
+    }
+
+    bool operator==(const StrView& other) const {
+        return _length == other._length && memcmp(_data, other._data, _length) == 0;
+    }
+
+    bool operator!=(const StrView& other) const { return !(*this == other); }
+
+    bool operator==(const __FlashStringHelper* other) const {
+        PGM_P str = reinterpret_cast<PGM_P>(other);
+        return strlen_P(str) == _length && memcmp_P(_data, str, _length) == 0;
+    }
+
+    // for HTTP header names and the like
+    bool equalsIgnoreCase(const __FlashStringHelper* other) const {
+        PGM_P str = reinterpret_cast<PGM_P>(other);
+        return strlen_P(str) == _length && strncasecmp_P(_data, str, _length) == 0;
+    }
+
+    // Leading decimal number, like String::toInt: an optional sign followed by
+    // digits, parsing stops at the first other character. 0 if there is none.
+    int32_t toInt() const {
+        size_t i = 0;
+        bool isNegative = false;
+        if (i < _length && (_data[i] == '-' || _data[i] == '+')) {
+            isNegative = _data[i++] == '-';
+        }
+        StrView digits = substr(i);
+        int32_t value = int32_t(digits.toUInt());
+        return isNegative ? -value : value;
+    }
+
+    uint32_t toUInt() const {
+        uint32_t value = 0;
+        for (size_t i = 0; i < _length && _data[i] >= '0' && _data[i] <= '9'; ++i) {
+            value = value * 10 + (_data[i] - '0');
+        }
+        return value;
+    }
+
+    float toFloat() const {
+        size_t dot = find('.');
+        float value = substr(0, dot).toInt();
+        if (dot == npos) {
+            return value;
+        }
+
+        float scale = 0.1f;
+        float fraction = 0;
+        for (size_t i = dot + 1; i < _length && _data[i] >= '0' && _data[i] <= '9'; ++i, scale /= 10) {
+            fraction += (_data[i] - '0') * scale;
+        }
+        return _length > 0 && _data[0] == '-' ? value - fraction : value + fraction;
+    }
+
+    // copies at most capacity - 1 characters and terminates, returns the count copied
+    size_t copyTo(char* dst, size_t capacity) const {
+        if (capacity == 0) {
+            return 0;
+        }
+        size_t length = _length < capacity - 1 ? _length : capacity - 1;
+        memcpy(dst, _data, length);
+        dst[length] = 0;
+        return length;
+    }
+
+    String toString() const {
+        String str;
+        if (str.reserve(_length)) {
+            str.concat(_data, _length);
+        }
+        return str;
+    }
+
+private:
+    static bool isSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+    }
+
+private:
+    const char* _data;
+    size_t _length;
+};
+
+#endif // __str_view_h
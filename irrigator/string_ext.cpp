@@ -1,4 +1,8 @@
 #include "string_ext.h"
+
+#include <Arduino.h>
+#include <pgmspace.h>
+#include <string.h>
 #include "common.h"
 
 int occurrenceCount(const String& src, char needle) {
@@ -32,100 +36,487 @@ String bisect(const String& src, const String& separator, String& tail) {
     return head;
 }
 
-static const String kBase64Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=";
+const __FlashStringHelper* flashStringAt(PGM_P list, int index) {
+    for (; index > 0; --index) {
+        while (pgm_read_byte(list++) != 0) {
+        }
+    }
+    return FPSTR(list);
+}
 
-bool base64Decode(const String& src, String& dst) {
-    if (src.length() % 4 != 0) {
-        return false;
+size_t copyFromFlash(char* dst, size_t capacity, const __FlashStringHelper* src) {
+    PGM_P p = reinterpret_cast<PGM_P>(src);
+    size_t length = strlen_P(p);
+    if (capacity > 0) {
+        size_t count = length < capacity - 1 ? length : capacity - 1;
+        memcpy_P(dst, p, count);
+        dst[count] = 0;
     }
+    return length;
+}
+
+bool containsFlash(const char* str, const __FlashStringHelper* needle) {
+    return strstr_P(str, reinterpret_cast<PGM_P>(needle)) != nullptr;
+}
 
-    char buf[src.length()*3 / 4 + 1];
+static const char kBase64Alphabet[64] PROGMEM = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
 
-    int j = 0;
-    int b[4];
+// sextet value of each character, kPad for '=' and kInvalid for anything else
+static const uint8_t kPad = 0x40;
+static const uint8_t kInvalid = 0x80;
+static const uint8_t kBase64Values[256] PROGMEM = {
+#define X kInvalid
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X, 62,  X,  X,  X, 63,
+   52, 53, 54, 55, 56, 57, 58, 59, 60, 61,  X,  X,  X, kPad, X, X,
+    X,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+   15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,  X,  X,  X,  X,  X,
+    X, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+   41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+    X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+#undef X
+};
 
-    for (int i = 0; i < src.length(); i += 4) {
-        b[0] = kBase64Alphabet.indexOf(src[i]);
-        b[1] = kBase64Alphabet.indexOf(src[i + 1]);
-        b[2] = kBase64Alphabet.indexOf(src[i + 2]);
-        b[3] = kBase64Alphabet.indexOf(src[i + 3]);
-        buf[j++] = (char) ((b[0] << 2) | (b[1] >> 4));
-        if (b[2] < 64) {
-            buf[j++] = (char) ((b[1] << 4) | (b[2] >> 2));
-            if (b[3] < 64)  {
-                buf[j++] = (char) ((b[2] << 6) | b[3]);
+static inline char base64Char(uint32_t sextet) {
+    return pgm_read_byte(kBase64Alphabet + (sextet & 0x3f));
+}
+
+static inline uint8_t base64Value(char ch) {
+    return pgm_read_byte(kBase64Values + uint8_t(ch));
+}
+
+// packs three bytes into the low 24 bits and splits them into four characters
+static inline void encodeBlock(const uint8_t* src, char* dst) {
+    uint32_t bits = (uint32_t(src[0]) << 16) | (uint32_t(src[1]) << 8) | src[2];
+    dst[0] = base64Char(bits >> 18);
+    dst[1] = base64Char(bits >> 12);
+    dst[2] = base64Char(bits >> 6);
+    dst[3] = base64Char(bits);
+}
+
+size_t Base64Encoder::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+
+    // complete the block left over from the previous write first
+    while (_pendingLength > 0 && _pendingLength < 3 && length > 0) {
+        _pending[_pendingLength++] = *data++;
+        --length;
+    }
+    if (_pendingLength == 3) {
+        written += appendBlock(_pending);
+        _pendingLength = 0;
+    }
+
+    for (; length >= 3; data += 3, length -= 3) {
+        written += appendBlock(data);
+    }
+
+    while (length > 0) {
+        _pending[_pendingLength++] = *data++;
+        --length;
+    }
+
+    return written;
+}
+
+size_t Base64Encoder::finish() {
+    size_t written = 0;
+
+    if (_pendingLength > 0) {
+        uint8_t block[3] = {_pending[0], uint8_t(_pendingLength > 1 ? _pending[1] : 0), 0};
+        written += appendBlock(block);
+
+        char* dst = _chunk + _chunkLength - 4;
+        dst[3] = '=';
+        if (_pendingLength == 1) {
+            dst[2] = '=';
+        }
+        _pendingLength = 0;
+    }
+
+    return written + flushChunk();
+}
+
+size_t Base64Encoder::appendBlock(const uint8_t* src) {
+    size_t written = 0;
+    if (_chunkLength == kChunkSize) {
+        written = flushChunk();
+    }
+
+    encodeBlock(src, _chunk + _chunkLength);
+    _chunkLength += 4;
+    return written;
+}
+
+size_t Base64Encoder::flushChunk() {
+    size_t written = _output.write(reinterpret_cast<const uint8_t*>(_chunk), _chunkLength);
+    _chunkLength = 0;
+    return written;
+}
+
+bool Base64Decoder::write(const char* data, size_t length) {
+    for (size_t i = 0; i < length && !_isFailed; ) {
+        // whole quanta without padding take the fast path, four lookups at a time
+        if (_count == 0 && !_isPadded) {
+            for (; length - i >= 4; i += 4) {
+                uint8_t a = base64Value(data[i]);
+                uint8_t b = base64Value(data[i + 1]);
+                uint8_t c = base64Value(data[i + 2]);
+                uint8_t d = base64Value(data[i + 3]);
+                if ((a | b | c | d) & (kPad | kInvalid)) {
+                    break;
+                }
+                emit((uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d, 3);
+            }
+            if (i == length) {
+                break;
             }
         }
+
+        push(data[i++]);
+    }
+
+    return !_isFailed;
+}
+
+void Base64Decoder::push(char ch) {
+    uint8_t value = base64Value(ch);
+
+    // nothing may follow the padding, which may only fill the last one or two places
+    if (value & kInvalid || (_isPadded && value != kPad) || (value == kPad && _count < 2)) {
+        _isFailed = true;
+        return;
+    }
+
+    if (value == kPad) {
+        _isPadded = true;
+        ++_paddingLength;
+        value = 0;
+    }
+
+    _bits = (_bits << 6) | value;
+    if (++_count < 4) {
+        return;
+    }
+
+    int byteCount = 3 - _paddingLength;
+    // the bits below the last byte have to be zero, or the encoding is not canonical
+    uint32_t unusedBits = _bits & ((uint32_t(1) << (8 * _paddingLength)) - 1);
+    if (unusedBits != 0) {
+        _isFailed = true;
+        return;
+    }
+
+    emit(_bits, byteCount);
+    _bits = 0;
+    _count = 0;
+    if (_isPadded) {
+        _isComplete = true;
+    }
+}
+
+void Base64Decoder::emit(uint32_t bits, int byteCount) {
+    if (_isComplete) {
+        _isFailed = true;
+        return;
+    }
+
+    if (_chunkLength + 3 > kChunkSize) {
+        flushChunk();
+    }
+
+    _chunk[_chunkLength++] = bits >> 16;
+    if (byteCount > 1) {
+        _chunk[_chunkLength++] = bits >> 8;
+    }
+    if (byteCount > 2) {
+        _chunk[_chunkLength++] = bits;
+    }
+}
+
+bool Base64Decoder::finish() {
+    flushChunk();
+    if (_count != 0) {
+        _isFailed = true;
+    }
+    return !_isFailed;
+}
+
+void Base64Decoder::flushChunk() {
+    _output.write(_chunk, _chunkLength);
+    _chunkLength = 0;
+}
+
+// Appends to a String. The callers reserve the final length up front.
+class StringPrint: public Print {
+public:
+    StringPrint(String& dst): _dst(dst) {}
+
+    size_t write(uint8_t ch) override {
+        _dst += char(ch);
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        _dst.concat(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+
+private:
+    String& _dst;
+};
+
+bool base64Decode(const String& src, String& dst) {
+    dst = "";
+    dst.reserve(src.length() / 4 * 3);
+
+    StringPrint output(dst);
+    Base64Decoder decoder(output);
+    decoder.write(src.c_str(), src.length());
+    if (!decoder.finish()) {
+        dst = "";
+        return false;
     }
-    buf[j] = 0;
-    dst = buf;
 
     return true;
 }
 
+bool base64Decode(Stream& src, Print& dst) {
+    Base64Decoder decoder(dst);
+
+    char buffer[64];
+    size_t length;
+    while ((length = src.readBytes(buffer, sizeof(buffer))) > 0) {
+        if (!decoder.write(buffer, length)) {
+            return false;
+        }
+    }
+
+    return decoder.finish();
+}
+
 bool base64Encode(const String& src, String& dst) {
-    char buf[src.length()*4 / 3 + 1];
+    dst = "";
+    dst.reserve((src.length() + 2) / 3 * 4);
 
-    unsigned int carry = 0;
-    int numExtraBits = 0;
-    int j = 0;
+    StringPrint output(dst);
+    base64Encode(reinterpret_cast<const uint8_t*>(src.c_str()), src.length(), output);
 
-    for (int i = 0; i < src.length(); ++i) {
-        carry |= src[i];
-        numExtraBits += 2;
+    return true;
+}
 
-        buf[j++] = kBase64Alphabet[carry >> numExtraBits];
-        carry &= (1 << numExtraBits) - 1;
+size_t base64Encode(const uint8_t* data, size_t length, Print& dst) {
+    Base64Encoder encoder(dst);
+    size_t written = encoder.write(data, length);
+    return written + encoder.finish();
+}
 
-        if (numExtraBits == 6) {
-            buf[j++] = kBase64Alphabet[carry];
-            carry = 0;
-            numExtraBits = 0;
-        }
+static const char kHexDigits[] PROGMEM = "0123456789ABCDEF";
 
-        carry <<= 8;
+// one bit per character that passes unencoded: the RFC 3986 unreserved set
+static const uint32_t kPercentSafeCharacters[8] PROGMEM = {
+    0x00000000, // 0x00-0x1f
+    0x03ff6000, // 0x20-0x3f: - . 0-9
+    0x87fffffe, // 0x40-0x5f: A-Z _
+    0x47fffffe, // 0x60-0x7f: a-z ~
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+};
+
+static inline bool isPercentSafe(uint8_t ch) {
+    return pgm_read_dword(kPercentSafeCharacters + (ch >> 5)) & (uint32_t(1) << (ch & 0x1f));
+}
+
+static inline int hexValue(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    ch |= 0x20;
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
     }
+    return -1;
+}
 
-    if (numExtraBits > 0) {
-        buf[j++] = kBase64Alphabet[carry >> (8 + numExtraBits - 6)];
+size_t percentEncodedLength(const char* src, size_t length) {
+    size_t encodedLength = length;
+    for (size_t i = 0; i < length; ++i) {
+        if (!isPercentSafe(src[i])) {
+            encodedLength += 2;
+        }
     }
+    return encodedLength;
+}
+
+size_t percentEncode(const char* src, size_t length, char* dst, size_t capacity) {
+    size_t j = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t ch = src[i];
+        if (isPercentSafe(ch)) {
+            if (j < capacity) {
+                dst[j] = ch;
+            }
+            ++j;
+            continue;
+        }
 
-    if (src.length() % 3 != 0) {
-        buf[j++] = '=';
+        if (j + 3 <= capacity) {
+            dst[j] = '%';
+            dst[j + 1] = pgm_read_byte(kHexDigits + (ch >> 4));
+            dst[j + 2] = pgm_read_byte(kHexDigits + (ch & 0xf));
+        }
+        j += 3;
     }
 
-    if (src.length() % 3 == 1) {
-        buf[j++] = '=';
+    return j;
+}
+
+size_t percentEncode(const char* src, size_t length, Print& dst) {
+    static const size_t kChunkSize = 48;
+    char chunk[kChunkSize];
+    size_t written = 0;
+
+    // the input is cut so that an escape never straddles two chunks
+    size_t start = 0;
+    while (start < length) {
+        size_t end = start;
+        size_t chunkLength = 0;
+        while (end < length) {
+            size_t width = isPercentSafe(src[end]) ? 1 : 3;
+            if (chunkLength + width > kChunkSize) {
+                break;
+            }
+            chunkLength += width;
+            ++end;
+        }
+
+        percentEncode(src + start, end - start, chunk, kChunkSize);
+        written += dst.write(reinterpret_cast<const uint8_t*>(chunk), chunkLength);
+        start = end;
     }
 
-    buf[j] = 0;
-    dst = buf;
+    return written;
+}
 
-    return true;
+size_t writeJSONString(const char* src, size_t length, Print& dst) {
+    size_t written = dst.write('"');
+
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t ch = src[i];
+        if (ch == '"' || ch == '\\') {
+            written += dst.write('\\');
+            written += dst.write(ch);
+        }
+        else if (ch < 0x20 || ch == '<' || ch == '>' || ch == '&') {
+            written += dst.print(F("\\u00"));
+            written += dst.write(pgm_read_byte(kHexDigits + (ch >> 4)));
+            written += dst.write(pgm_read_byte(kHexDigits + (ch & 0xf)));
+        }
+        else {
+            written += dst.write(ch);
+        }
+    }
+
+    written += dst.write('"');
+    return written;
 }
 
-static const char kHexDigits[] = "0123456789ABCDEF";
+size_t writeHTMLEscaped(const char* src, size_t length, Print& dst) {
+    size_t written = 0;
+    size_t start = 0;
 
-bool formURLEncode(const String& src, String& dst) {
-    String str(src);
-    str.replace("%", "%%");
+    for (size_t i = 0; i < length; ++i) {
+        const __FlashStringHelper* entity;
+        switch (src[i]) {
+            case '<':
+                entity = F("&lt;");
+                break;
+            case '>':
+                entity = F("&gt;");
+                break;
+            case '&':
+                entity = F("&amp;");
+                break;
+            case '"':
+                entity = F("&quot;");
+                break;
+            case '\'':
+                entity = F("&#39;");
+                break;
+            default:
+                continue;
+        }
+
+        written += dst.write(reinterpret_cast<const uint8_t*>(src + start), i - start);
+        written += dst.print(entity);
+        start = i + 1;
+    }
+
+    written += dst.write(reinterpret_cast<const uint8_t*>(src + start), length - start);
+    return written;
+}
+
+int percentDecode(const char* src, size_t length, char* dst, bool isForm) {
+    size_t j = 0;
 
-    for (int i = 0; i < str.length(); ++i) {
-        int ch = str[i];
-        if (!(ch == '%' ||
-              ch >= 'A' && ch <= 'Z' || 
-              ch >= 'a' && ch <= 'z' || 
-              ch >= '0' && ch <= '9' || 
-              ch == '-' || ch == '_' || ch == '.' || ch == '~')) {
-            char encoded[4] = { '%', 0, 0, 0 };
-            encoded[1] = kHexDigits[(ch >> 4) & 0xf];
-            encoded[2] = kHexDigits[ch & 0xf];
-            str.replace(String((char)ch), encoded);
+    for (size_t i = 0; i < length; ++i) {
+        char ch = src[i];
+        if (ch == '%') {
+            int high = i + 2 < length ? hexValue(src[i + 1]) : -1;
+            int low = high >= 0 ? hexValue(src[i + 2]) : -1;
+            if (low < 0) {
+                return -1;
+            }
+            dst[j++] = (high << 4) | low;
+            i += 2;
+        }
+        else if (ch == '+' && isForm) {
+            dst[j++] = ' ';
+        }
+        else {
+            dst[j++] = ch;
         }
     }
 
-    dst = str;
+    return j;
+}
+
+bool formURLEncode(const String& src, String& dst) {
+    size_t length = percentEncodedLength(src.c_str(), src.length());
+    dst = "";
+    if (!dst.reserve(length)) {
+        return false;
+    }
+
+    StringPrint output(dst);
+    percentEncode(src.c_str(), src.length(), output);
 
     return true;
 }
 
+bool formURLDecode(const String& src, String& dst) {
+    // decoding never grows the input, so it works in place on a copy
+    String decoded(src);
+    int length = percentDecode(decoded.c_str(), decoded.length(), decoded.begin(), true);
+    if (length < 0) {
+        return false;
+    }
+
+    decoded.remove(length);
+    dst = decoded;
+
+    return true;
+}
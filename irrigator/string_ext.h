@@ -1,12 +1,117 @@
 #ifndef __string_ext_h
 #define __string_ext_h
 
+#include <Print.h>
+#include <Stream.h>
 #include <WString.h>
+#include <pgmspace.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+// Name tables live in flash as one array of NUL separated strings, e.g.
+//   static constexpr char kNames[] PROGMEM = "first\0" "second";
+// which costs no RAM, unlike an array of pointers to literals.
+constexpr size_t flashStringCount(const char* list, size_t size) {
+    return size == 0 ? 0 : (list[size - 1] == 0) + flashStringCount(list, size - 1);
+}
+
+// the index-th string of such a list, which must have more than index strings
+extern const __FlashStringHelper* flashStringAt(PGM_P list, int index);
+
+// Copies a flash string into RAM, for APIs that cannot read flash, cut to fit and
+// always terminated. Returns the full length of the source.
+extern size_t copyFromFlash(char* dst, size_t capacity, const __FlashStringHelper* src);
+
+extern bool containsFlash(const char* str, const __FlashStringHelper* needle);
 
 extern int occurrenceCount(const String& src, char needle);
 extern String bisect(const String& src, const String& separator, String& tail);
 extern bool base64Decode(const String& src, String& dst);
+extern bool base64Decode(Stream& src, Print& dst);
 extern bool base64Encode(const String& src, String& dst);
+extern size_t base64Encode(const uint8_t* data, size_t length, Print& dst);
 extern bool formURLEncode(const String& src, String& dst);
+extern bool formURLDecode(const String& src, String& dst);
+
+// Percent encoding in a single pass. Everything but the RFC 3986 unreserved
+// characters is escaped, so the output suits both URLs and form bodies.
+// Encoding into a buffer returns the full encoded length even if it did not fit.
+extern size_t percentEncodedLength(const char* src, size_t length);
+extern size_t percentEncode(const char* src, size_t length, char* dst, size_t capacity);
+extern size_t percentEncode(const char* src, size_t length, Print& dst);
+// Decodes into dst, which may be src. Form decoding also turns '+' into a space.
+// Returns the decoded length, or -1 for a malformed escape.
+extern int percentDecode(const char* src, size_t length, char* dst, bool isForm);
+
+// Writes a quoted JSON string, escaping quotes, backslashes and control characters.
+// Markup characters are escaped too, so the string stays inert if a client renders it as HTML.
+// Returns the length written.
+extern size_t writeJSONString(const char* src, size_t length, Print& dst);
+
+// Writes text for an HTML element or a quoted attribute, escaping markup and quotes.
+// Returns the length written.
+extern size_t writeHTMLEscaped(const char* src, size_t length, Print& dst);
+
+// Encodes base64 incrementally into a Print, in chunks rather than per character.
+// finish() pads and writes the last block.
+class Base64Encoder {
+public:
+    Base64Encoder(Print& output): _output(output), _pendingLength(0), _chunkLength(0) {}
+
+    size_t write(const uint8_t* data, size_t length);
+    size_t finish();
+
+private:
+    size_t appendBlock(const uint8_t* src);
+    size_t flushChunk();
+
+private:
+    static const int kChunkSize = 64;
+
+    Print& _output;
+    uint8_t _pending[3];
+    uint8_t _pendingLength;
+    char _chunk[kChunkSize];
+    int _chunkLength;
+};
+
+// Decodes base64 incrementally into a Print. Decoding is strict: characters
+// outside the alphabet, misplaced padding, non-zero unused bits and incomplete
+// blocks fail it, and output already written stays with the caller.
+class Base64Decoder {
+public:
+    Base64Decoder(Print& output):
+        _output(output),
+        _bits(0),
+        _count(0),
+        _paddingLength(0),
+        _isPadded(false),
+        _isComplete(false),
+        _isFailed(false),
+        _chunkLength(0) {}
+
+    bool write(const char* data, size_t length);
+    bool finish();
+    bool isFailed() const { return _isFailed; }
+
+private:
+    void push(char ch);
+    void emit(uint32_t bits, int byteCount);
+    void flushChunk();
+
+private:
+    static const int kChunkSize = 48;
+
+    Print& _output;
+    uint32_t _bits;
+    uint8_t _count;
+    uint8_t _paddingLength;
+    bool _isPadded;
+    bool _isComplete;
+    bool _isFailed;
+    uint8_t _chunk[kChunkSize];
+    int _chunkLength;
+};
 
 #endif // __string_ext_h
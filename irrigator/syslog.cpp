@@ -0,0 +1,111 @@
+#include "syslog.h"
+
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "clock.h"
+#include "common.h"
+#include "scheduler.h"
+
+static constexpr TimeInterval kFlushInterval = 1_s;
+// flush right away once this many records are pending
+static const uint32_t kBatchSize = 8;
+// bounds the time a single flush can take from the loop
+static const int kMaxPacketsPerFlush = 16;
+
+static const uint8_t kFacilityLocal0 = 16;
+// syslog severities indexed by LogLevel
+static const uint8_t kSeverities[] = {7, 3, 4, 6, 7};
+
+static WiFiUDP udp;
+
+SyslogClass Syslog;
+
+SyslogClass::SyslogClass():
+    _port(kDefaultPort),
+    _isEnabled(false),
+    _cursor(0),
+    _lastFlushTime(0),
+    _sentCount(0),
+    _lostCount(0) {
+}
+
+void SyslogClass::begin(const IPAddress& server, uint16_t port) {
+    _server = server;
+    _port = port;
+    _isEnabled = true;
+    // start with the records still in the ring, i.e. the tail of the boot log
+    _cursor = Logger.firstSequence();
+}
+
+void SyslogClass::end() {
+    _isEnabled = false;
+}
+
+void SyslogClass::flush() {
+    if (!_isEnabled || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+
+    uint32_t pendingCount = Logger.nextSequence() - _cursor;
+    if (pendingCount == 0) {
+        return;
+    }
+
+    DeviceTime now = Clock.deviceTimeSnapshot();
+    if (pendingCount < kBatchSize && now.timeIntervalSince(_lastFlushTime) < kFlushInterval) {
+        return;
+    }
+    _lastFlushTime = now;
+
+    uint32_t first = Logger.firstSequence();
+    if (int32_t(first - _cursor) > 0) {
+        _lostCount += first - _cursor;
+        _cursor = first;
+    }
+
+    // no logging in here: it would feed the records back into the queue
+    for (int i = 0; i < kMaxPacketsPerFlush && _cursor != Logger.nextSequence(); ++i) {
+        if (send(_cursor)) {
+            ++_sentCount;
+        }
+        else {
+            ++_lostCount;
+        }
+        ++_cursor;
+    }
+}
+
+TimeInterval SyslogClass::timeIntervalTillFlush() const {
+    // without WiFi a flush cannot make progress: the wake on the WiFi event
+    // resumes forwarding, instead of the loop spinning on a pending batch
+    uint32_t pendingCount = Logger.nextSequence() - _cursor;
+    if (!_isEnabled || pendingCount == 0 || WiFi.status() != WL_CONNECTED) {
+        return SchedulerClass::noDeadline();
+    }
+
+    if (pendingCount >= kBatchSize) {
+        return TimeInterval::withSeconds(0);
+    }
+
+    return (_lastFlushTime + kFlushInterval).timeIntervalSince(Clock.deviceTimeSnapshot());
+}
+
+bool SyslogClass::send(uint32_t sequence) {
+    const LoggerClass::Record* record = Logger.record(sequence);
+    if (!record || !udp.beginPacket(_server, _port)) {
+        return false;
+    }
+
+    // <PRI>VERSION TIMESTAMP HOSTNAME APP-NAME PROCID MSGID STRUCTURED-DATA MSG,
+    // the collector stamps the time of arrival
+    udp.print('<');
+    udp.print(kFacilityLocal0 * 8 + kSeverities[record->level]);
+    udp.print(F(">1 - irrigator "));
+    udp.print(LoggerClass::moduleName(record->module));
+    udp.print(F(" - - - "));
+    udp.print(record->timestamp);
+    udp.print(F("ms "));
+    Logger.formatMessage(*record, udp);
+
+    return udp.endPacket();
+}
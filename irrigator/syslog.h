@@ -0,0 +1,49 @@
+#ifndef __syslog_h
+#define __syslog_h
+
+#include <IPAddress.h>
+#include <stdint.h>
+#include "time.h"
+
+// Forwards the log to a syslog collector over UDP (RFC 5424, facility local0).
+// Records are sent in batches from the main loop; a UDP send only hands the
+// datagram over to the network stack, so forwarding never waits on the network.
+// To watch the log from a machine on the LAN, point the forwarder at it and run
+// e.g. `sudo nc -ulk 514` there, 514 being a privileged port; an unprivileged
+// listener works just as well with its port set as kSyslogPort.
+class SyslogClass {
+public:
+    static const uint16_t kDefaultPort = 514;
+
+public:
+    SyslogClass();
+
+    void begin(const IPAddress& server, uint16_t port = kDefaultPort);
+    void end();
+
+    bool isEnabled() const { return _isEnabled; }
+
+    // sends the records logged since the last flush, at most once per flush interval
+    void flush();
+    TimeInterval timeIntervalTillFlush() const;
+
+    uint32_t sentCount() const { return _sentCount; }
+    // records that could not be sent or were overwritten before they could be
+    uint32_t lostCount() const { return _lostCount; }
+
+private:
+    bool send(uint32_t sequence);
+
+private:
+    IPAddress _server;
+    uint16_t _port;
+    bool _isEnabled;
+    uint32_t _cursor;
+    DeviceTime _lastFlushTime;
+    uint32_t _sentCount;
+    uint32_t _lostCount;
+};
+
+extern SyslogClass Syslog;
+
+#endif // __syslog_h
@@ -1,22 +1,29 @@
 #include <ESP8266WiFi.h>
+#include <string.h>
 
 #include "common.h"
 #include "http_response.h"
+#include "profiler.h"
+#include "str_builder.h"
 #include "string_ext.h"
 #include "thingtweet.h"
 
-static const char kThingTweetAPIKey[] = "*";
+static const char kThingTweetAPIKey[] PROGMEM = "*";
 
 
 bool tweetStatus(const String& status) {
     if (WiFi.status() != WL_CONNECTED) {
-        LOG(F("[thingtweet] failed: not connected\n"));
+        LOG_WARNING(ThingTweet, "failed: not connected\n");
         return false;
     }
 
+    ProfilerScope scope(kProbeCallThingTweet);
+
     IPAddress serverIP;
-    if (!WiFi.hostByName("api.thingspeak.com", serverIP)) {
-        LOG(F("[thingtweet] error: cannot resolve server host\n"));
+    char host[kMaxHostNameLength];
+    copyFromFlash(host, sizeof(host), F("api.thingspeak.com"));
+    if (!WiFi.hostByName(host, serverIP)) {
+        LOG_ERROR(ThingTweet, "cannot resolve server host\n");
         return false;
     }
 
@@ -29,23 +36,34 @@ bool tweetStatus(const String& status) {
     }
 
     if (!client.connected()) {
-        LOG(F("[thingtweet] error: cannot connect to server\n"));
+        LOG_ERROR(ThingTweet, "cannot connect to server\n");
         return false;
     }
 
-    String formEncoded;
-    formURLEncode(status, formEncoded);
+    // the status is encoded straight into the connection, sized up front
+    static const char kPayloadPrefix[] PROGMEM = "api_key=";
+    static const char kStatusField[] PROGMEM = "&status=";
+    size_t payloadLength = strlen_P(kPayloadPrefix) + strlen_P(kThingTweetAPIKey) + strlen_P(kStatusField) +
+        percentEncodedLength(status.c_str(), status.length());
 
-    String payload = String("api_key=") + kThingTweetAPIKey + "&status=" + formEncoded;
-    String header(F("POST /apps/thingtweet/1/statuses/update HTTP/1.1\r\n"));
-    header += F("Host: api.thingspeak.com\r\n");
-    header += F("Content-Type: application/x-www-form-urlencoded\r\n");
-    header += F("Content-Length: ");
-    header += String(payload.length());
-    header += F("\r\n\r\n");
+    char buffer[192];
+    StrBuilder header(buffer, sizeof(buffer));
+    header.append(F("POST /apps/thingtweet/1/statuses/update HTTP/1.1\r\n"));
+    header.append(F("Host: api.thingspeak.com\r\n"));
+    header.append(F("Content-Type: application/x-www-form-urlencoded\r\n"));
+    header.append(F("Content-Length: "));
+    header.append(uint32_t(payloadLength));
+    header.append(F("\r\n\r\n"));
+    header.append(FPSTR(kPayloadPrefix));
+    header.append(FPSTR(kThingTweetAPIKey));
+    header.append(FPSTR(kStatusField));
+    if (header.isOverflowed()) {
+        LOG_ERROR(ThingTweet, "request header too long\n");
+        return false;
+    }
 
-    client.print(header);
-    client.print(payload);
+    client.write(header.c_str(), header.length());
+    percentEncode(status.c_str(), status.length(), client);
 
     interval = 10;
     while (!client.available() && interval < 1000) {
@@ -54,17 +72,17 @@ bool tweetStatus(const String& status) {
     }
 
     if (!client.available()) {
-        LOG(F("[thingtweet] error: connection reset\n"));
+        LOG_ERROR(ThingTweet, "connection reset\n");
         return false;
     }
 
     HTTPResponse response(client);
     if (response.statusCode() != 200) {
-        LOG(String(F("[thingtweet] error: server returned ")) + String(response.statusCode()) + F("\n"));
+        LOG_ERROR(ThingTweet, "server returned %d\n", response.statusCode());
         return false;
     }
 
-    LOG(String(F("[thingtweet] status tweeted [")) + status + "]\n");
+    LOG_INFO(ThingTweet, "status tweeted [%s]\n", status);
 
     return true;
 }
@@ -1,20 +1,101 @@
 #include "time.h"
 
-String TimeInterval::toHumanReadableString() const {
-    if (*this == TimeInterval::neverInThePast() || *this == TimeInterval::neverInTheFuture()) {
-        return "never";
+#include <WString.h>
+#include <pgmspace.h>
+
+static_assert(DeviceTime(1000) + 15_min == DeviceTime(901000), "time arithmetic folds at compile time");
+static_assert(CumulativeTime(DeviceTime(0), 1_h) - 1_h == CumulativeTime(DeviceTime(0)),
+              "time arithmetic folds at compile time");
+
+// appends to a fixed buffer, dropping whatever does not fit
+class FormatBuffer {
+public:
+    FormatBuffer(char* buffer, size_t capacity): _buffer(buffer), _capacity(capacity), _length(0) {
+        terminate();
+    }
+
+    void append(char ch) {
+        if (_length + 1 < _capacity) {
+            _buffer[_length++] = ch;
+            terminate();
+        }
+    }
+
+    void append(const __FlashStringHelper* str) {
+        PGM_P p = reinterpret_cast<PGM_P>(str);
+        for (char ch = pgm_read_byte(p); ch != 0; ch = pgm_read_byte(++p)) {
+            append(ch);
+        }
+    }
+
+    void append(uint32_t value) {
+        char digits[10];
+        int count = 0;
+        do {
+            digits[count++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        while (count > 0) {
+            append(digits[--count]);
+        }
+    }
+
+    size_t length() const { return _length; }
+
+private:
+    void terminate() {
+        if (_capacity > 0) {
+            _buffer[_length] = 0;
+        }
+    }
+
+    char* _buffer;
+    size_t _capacity;
+    size_t _length;
+};
+
+size_t TimeInterval::format(char* buffer, size_t capacity, TimeIntervalFormat format) const {
+    FormatBuffer output(buffer, capacity);
+
+    if (*this == neverInThePast() || *this == neverInTheFuture()) {
+        output.append(F("never"));
+        return output.length();
     }
 
     int32_t s = seconds();
-    int32_t hours = abs(s / 3600);
-    int minutes = abs((s % 3600) / 60);
-    int secs = abs(s % 60);
-    String space1 = hours > 0 && minutes > 0 ? " " : "";
-    String space2 = (hours > 0 || minutes > 0) && secs > 0 ? " " : "";
-
-    return (hours > 0 ? String(hours) + "h" : String()) + 
-           space1 + 
-           (minutes > 0 ? String(minutes) + "m" : String()) +
-           space2 + 
-           (secs > 0 ? String(secs) + "s" : String());
+    // the magnitude, which also holds for INT32_MIN
+    uint32_t magnitude = s < 0 ? uint32_t(0) - uint32_t(s) : uint32_t(s);
+    uint32_t hours = magnitude / 3600;
+    uint32_t minutes = (magnitude % 3600) / 60;
+    uint32_t secs = magnitude % 60;
+
+    if (s < 0) {
+        output.append('-');
+    }
+
+    bool isISO8601 = format == kTimeIntervalFormatISO8601;
+    if (isISO8601) {
+        output.append(F("PT"));
+    }
+
+    if (hours > 0) {
+        output.append(hours);
+        output.append(isISO8601 ? 'H' : 'h');
+    }
+    if (minutes > 0) {
+        if (hours > 0 && !isISO8601) {
+            output.append(' ');
+        }
+        output.append(minutes);
+        output.append(isISO8601 ? 'M' : 'm');
+    }
+    if (secs > 0 || (hours == 0 && minutes == 0)) {
+        if ((hours > 0 || minutes > 0) && !isISO8601) {
+            output.append(' ');
+        }
+        output.append(secs);
+        output.append(isISO8601 ? 'S' : 's');
+    }
+
+    return output.length();
 }
@@ -1,46 +1,62 @@
 #ifndef __time_h
 #define __time_h
 
-#include <WString.h>
+#include <stddef.h>
 #include <stdint.h>
 
 template <typename T> class Time;
 
+typedef enum {
+    kTimeIntervalFormatHuman = 0,   // "1h 2m 3s"
+    kTimeIntervalFormatISO8601,     // "PT1H2M3S"
+} TimeIntervalFormat;
+
+// Everything that only combines constants is constexpr, so intervals built from
+// literals such as 15_min are folded at compile time rather than initialised at boot.
 class TimeInterval {
 public:
     static const int kNumFractionBits = 16;
     static const uint64_t kFractionMask = (uint64_t(1) << kNumFractionBits) - 1;
     static const uint64_t kSignMask = uint64_t(1) << 63;
+
+    // fits any interval in either format, including the terminator
+    static const size_t kMaxFormattedLength = 20;
 public:
-    static TimeInterval withSeconds(int32_t sec) {
-        return TimeInterval(int64_t(sec) << kNumFractionBits);
+    static constexpr TimeInterval withSeconds(int32_t sec) {
+        return TimeInterval(uint64_t(int64_t(sec) * (int64_t(1) << kNumFractionBits)));
+    }
+
+    static constexpr TimeInterval withMilliseconds(int32_t msec) {
+        return TimeInterval(uint64_t(int64_t(msec) * (int64_t(1) << kNumFractionBits) / 1000));
     }
 
-    static TimeInterval withMilliseconds(int32_t msec) {
-        return TimeInterval((int64_t(msec) << kNumFractionBits) / 1000);
+    static constexpr TimeInterval withTicks(int64_t ticks) {
+        return TimeInterval(uint64_t(ticks));
     }
 
-    static TimeInterval neverInThePast() {
+    static constexpr TimeInterval neverInThePast() {
         return TimeInterval(~uint64_t(0));
     }
 
-    static TimeInterval neverInTheFuture() {
+    static constexpr TimeInterval neverInTheFuture() {
         return TimeInterval(~uint64_t(0) | kSignMask);
     }
 
-    int32_t seconds() const {
+    constexpr int32_t seconds() const {
         return _ticks >> kNumFractionBits;
     }
 
+    constexpr int32_t milliseconds() const {
+        return (_ticks * 1000) >> kNumFractionBits;
+    }
+
     int16_t fractionInMilliseconds() const {
         int64_t signedFraction = _ticks & (kFractionMask | kSignMask);
         return (signedFraction * 1000) >> (kNumFractionBits - 1);
     }
 
-    TimeInterval operator+(const TimeInterval& other) const {
-        TimeInterval ti = *this;
-        ti += other;
-        return ti;
+    constexpr TimeInterval operator+(const TimeInterval& other) const {
+        return TimeInterval(uint64_t(_ticks + other._ticks));
     }
 
     TimeInterval& operator+=(const TimeInterval& ti) {
@@ -48,10 +64,8 @@ public:
         return *this;
     }
 
-    TimeInterval operator-(const TimeInterval& other) const {
-        TimeInterval ti = *this;
-        ti -= other;
-        return ti;
+    constexpr TimeInterval operator-(const TimeInterval& other) const {
+        return TimeInterval(uint64_t(_ticks - other._ticks));
     }
 
     TimeInterval& operator-=(const TimeInterval& ti) {
@@ -59,34 +73,36 @@ public:
         return *this;
     }
 
-    bool operator==(const TimeInterval& other) const {
+    constexpr bool operator==(const TimeInterval& other) const {
         return _ticks == other._ticks;
     }
 
-    bool operator!=(const TimeInterval& other) const {
+    constexpr bool operator!=(const TimeInterval& other) const {
         return _ticks != other._ticks;
     }
 
-    bool operator<(const TimeInterval& other) const {
+    constexpr bool operator<(const TimeInterval& other) const {
         return _ticks < other._ticks;
     }
 
-    bool operator<=(const TimeInterval& other) const {
+    constexpr bool operator<=(const TimeInterval& other) const {
         return _ticks <= other._ticks;
     }
 
-    bool operator>(const TimeInterval& other) const {
+    constexpr bool operator>(const TimeInterval& other) const {
         return _ticks > other._ticks;
     }
 
-    bool operator>=(const TimeInterval& other) const {
+    constexpr bool operator>=(const TimeInterval& other) const {
         return _ticks >= other._ticks;
     }
 
-    String toHumanReadableString() const;
+    // Writes the interval into buffer, cut to fit and always terminated. "never"
+    // for the never* intervals. Returns the length written.
+    size_t format(char* buffer, size_t capacity, TimeIntervalFormat format = kTimeIntervalFormatHuman) const;
 
 private:
-    TimeInterval(uint64_t ticks): _ticks(ticks) {} 
+    constexpr TimeInterval(uint64_t ticks): _ticks(ticks) {}
     
 public:
     int64_t _ticks;
@@ -94,70 +110,67 @@ public:
     template <typename T> friend class Time;
 };
 
-// generic time class
+// generic time class, constexpr like TimeInterval, so that e.g. time + 15_min
+// with a constant time folds too
 template <typename T>
 class Time {
 public:
-    static T distantPast() { return Time(TimeInterval::neverInThePast()._ticks); }
-    static T distantFuture() { return Time(TimeInterval::neverInTheFuture()._ticks); }
+    static constexpr T distantPast() { return T(Time(TimeInterval::neverInThePast()._ticks)); }
+    static constexpr T distantFuture() { return T(Time(TimeInterval::neverInTheFuture()._ticks)); }
 
-    uint32_t seconds() const { return _interval.seconds(); }
+    constexpr uint32_t seconds() const { return _interval.seconds(); }
     uint16_t fractionInMilliseconds() const { return _interval.fractionInMilliseconds(); }
 
-    T operator+(const TimeInterval& ti) const {
-        T t = *this;
-        t._interval += ti;
-        return t;
+    constexpr T operator+(const TimeInterval& ti) const {
+        return T(Time(uint64_t(_interval._ticks + ti._ticks)));
     }
 
     T& operator+=(const TimeInterval& ti) {
         _interval += ti;
-        return *this;
+        return static_cast<T&>(*this);
     }
 
-    T operator-(const TimeInterval& ti) const {
-        T t = *this;
-        t._interval -= ti;
-        return t;
+    constexpr T operator-(const TimeInterval& ti) const {
+        return T(Time(uint64_t(_interval._ticks - ti._ticks)));
     }
 
     T& operator-=(const TimeInterval& ti) {
         _interval -= ti;
-        return *this;
+        return static_cast<T&>(*this);
     }
 
-    bool operator==(const T& other) const {
+    constexpr bool operator==(const T& other) const {
         return _interval == other._interval;
     }
 
-    bool operator!=(const T& other) const {
+    constexpr bool operator!=(const T& other) const {
         return _interval != other._interval;
     }
 
-    bool operator<(const T& other) const {
+    constexpr bool operator<(const T& other) const {
         return _interval < other._interval;
     }
     
-    bool operator<=(const T& other) const {
+    constexpr bool operator<=(const T& other) const {
         return _interval <= other._interval;
     }
 
-    bool operator>(const T& other) const {
+    constexpr bool operator>(const T& other) const {
         return _interval > other._interval;
     }
 
-    bool operator>=(const T& other) const {
+    constexpr bool operator>=(const T& other) const {
         return _interval >= other._interval;
     }
 
-    const TimeInterval& timeIntervalSinceReferenceTime() const { return _interval; }
+    constexpr const TimeInterval& timeIntervalSinceReferenceTime() const { return _interval; }
 
-    TimeInterval timeIntervalSince(const T& other) const {
+    constexpr TimeInterval timeIntervalSince(const T& other) const {
         return _interval - other._interval;
     }
 
 protected:
-    Time(uint64_t ticks): _interval(ticks) {}
+    constexpr Time(uint64_t ticks): _interval(ticks) {}
 
 private:
     TimeInterval _interval;
@@ -167,35 +180,56 @@ private:
 // time since the Unix Epoch
 class UnixTime: public Time<UnixTime> {
 public:
-    explicit UnixTime(uint32_t timestamp):
+    explicit constexpr UnixTime(uint32_t timestamp):
         Time(uint64_t(timestamp) << TimeInterval::kNumFractionBits) {
     }
 
-    UnixTime(const Time<UnixTime>& base): Time(base) {}
+    constexpr UnixTime(const Time<UnixTime>& base): Time(base) {}
 };
 
 // time since last boot
 class DeviceTime: public Time<DeviceTime> {
 public:
-    explicit DeviceTime(unsigned long msec, uint16_t overflow = 0):
+    explicit constexpr DeviceTime(unsigned long msec, uint16_t overflow = 0):
         Time((((uint64_t(overflow) << 32) | msec) << TimeInterval::kNumFractionBits) / 1000) {
     }
 
-    DeviceTime(const Time<DeviceTime>& base): Time(base) {}
+    static constexpr DeviceTime withTimeIntervalSinceReferenceTime(const TimeInterval& ti) {
+        return DeviceTime(ti);
+    }
+
+    constexpr DeviceTime(const Time<DeviceTime>& base): Time(base) {}
+
+private:
+    explicit constexpr DeviceTime(const TimeInterval& ti): Time(ti._ticks) {}
 };
 
 // approximate accumulated uptime since first boot
 class CumulativeTime: public Time<CumulativeTime> {
 public:
-    explicit CumulativeTime(const DeviceTime& localTime, 
-                            const TimeInterval& previousUptime = TimeInterval::withSeconds(0)):
-        Time(({
-            TimeInterval interval = localTime.timeIntervalSinceReferenceTime() + previousUptime;
-            (uint64_t)interval._ticks;
-        })) {
+    explicit constexpr CumulativeTime(const DeviceTime& localTime,
+                                      const TimeInterval& previousUptime = TimeInterval::withSeconds(0)):
+        Time(uint64_t((localTime.timeIntervalSinceReferenceTime() + previousUptime)._ticks)) {
     }
 
-    CumulativeTime(const Time<CumulativeTime>& base): Time(base) {}
+    constexpr CumulativeTime(const Time<CumulativeTime>& base): Time(base) {}
 };
 
+// Interval literals, e.g. 500_ms, 10_s, 15_min or 24_h
+constexpr TimeInterval operator"" _ms(unsigned long long msec) {
+    return TimeInterval::withMilliseconds(int32_t(msec));
+}
+
+constexpr TimeInterval operator"" _s(unsigned long long sec) {
+    return TimeInterval::withSeconds(int32_t(sec));
+}
+
+constexpr TimeInterval operator"" _min(unsigned long long min) {
+    return TimeInterval::withSeconds(int32_t(min * 60));
+}
+
+constexpr TimeInterval operator"" _h(unsigned long long hours) {
+    return TimeInterval::withSeconds(int32_t(hours * 60 * 60));
+}
+
 #endif // __time_h
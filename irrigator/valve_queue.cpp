@@ -0,0 +1,68 @@
+#include "valve_queue.h"
+
+#include "scheduler.h"
+
+ValveQueueClass ValveQueue;
+
+ValveQueueClass::ValveQueueClass():
+    _nextID(1),
+    _isRunning(false),
+    _completedCount(0),
+    _rejectedCount(0) {
+}
+
+uint16_t ValveQueueClass::post(const IrrigatorClass::Task& task) {
+    if (_commands.isFull()) {
+        ++_rejectedCount;
+        LOG_WARNING(Irrigator, "command queue full, dropping command for valve %u\n", task.valve);
+        return 0;
+    }
+
+    Command command;
+    command.id = _nextID;
+    command.task = task;
+    _commands.push(command);
+
+    // 0 is reserved for rejected commands
+    if (++_nextID == 0) {
+        _nextID = 1;
+    }
+
+    LOG_INFO(Irrigator, "queued command #%u for valve %u (depth %d)\n", command.id, task.valve, depth());
+    return command.id;
+}
+
+void ValveQueueClass::run() {
+    Irrigator.update();
+
+    if (_isRunning) {
+        if (!Irrigator.updateTask()) {
+            return;
+        }
+
+        Irrigator.endTask();
+        _isRunning = false;
+        ++_completedCount;
+        LOG_INFO(Irrigator, "command #%u done\n", _running.id);
+    }
+
+    if (_commands.isEmpty()) {
+        return;
+    }
+
+    _running = _commands.front();
+    _commands.pop();
+    _isRunning = true;
+
+    LOG_INFO(Irrigator, "running command #%u\n", _running.id);
+    Irrigator.beginTask(_running.task);
+}
+
+TimeInterval ValveQueueClass::timeIntervalTillNextStep() const {
+    if (!_isRunning && !_commands.isEmpty()) {
+        return TimeInterval::withSeconds(0);
+    }
+
+    // covers the running command as well as the valves it left to close
+    return Irrigator.timeIntervalTillUpdate();
+}
@@ -0,0 +1,56 @@
+#ifndef __valve_queue_h
+#define __valve_queue_h
+
+#include <stdint.h>
+#include "irrigator.h"
+#include "ring_buffer.h"
+#include "time.h"
+
+// Bounded queue of manual valve commands posted by the web service. Posting
+// returns at once, the commands are run one after the other from the loop and
+// take priority over the duty cycle.
+class ValveQueueClass {
+public:
+    static const int kCapacity = 8;
+
+    struct Command {
+        uint16_t id;
+        IrrigatorClass::Task task;
+    };
+
+public:
+    ValveQueueClass();
+
+    // returns the id of the queued command, 0 if the queue is full
+    uint16_t post(const IrrigatorClass::Task& task);
+
+    // starts, advances or finishes the running command, the next one starts
+    // while the valves of the previous one are still closing
+    void run();
+
+    bool isActive() const { return _isRunning || !_commands.isEmpty(); }
+    bool isRunning() const { return _isRunning; }
+    const Command& runningCommand() const { return _running; }
+
+    int depth() const { return _commands.size(); }
+    const Command& pendingCommand(int index) const { return _commands[index]; }
+
+    uint32_t completedCount() const { return _completedCount; }
+    uint32_t rejectedCount() const { return _rejectedCount; }
+
+    TimeInterval timeIntervalTillNextStep() const;
+
+private:
+    RingBuffer<Command, kCapacity> _commands;
+    uint16_t _nextID;
+
+    bool _isRunning;
+    Command _running;
+
+    uint32_t _completedCount;
+    uint32_t _rejectedCount;
+};
+
+extern ValveQueueClass ValveQueue;
+
+#endif // __valve_queue_h
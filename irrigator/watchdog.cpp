@@ -0,0 +1,126 @@
+#include "watchdog.h"
+
+#include <Arduino.h>
+#include <user_interface.h>
+
+#include "common.h"
+#include "irrigator.h"
+#include "profiler.h"
+#include "string_ext.h"
+
+static const uint32_t kSnapshotMagic = 0x57444f47; // "WDOG"
+static const int kSnapshotSizeInWords = sizeof(WatchdogClass::Snapshot) / sizeof(uint32_t);
+
+static_assert(sizeof(WatchdogClass::Snapshot) % sizeof(uint32_t) == 0,
+              "RTC memory is accessed in 4 byte blocks");
+static_assert(kRTCWatchdogSnapshot + kSnapshotSizeInWords <= kRTCClockState,
+              "the watchdog snapshot overlaps the next RTC memory region");
+
+static constexpr char kSubsystemNames[] PROGMEM = "loop\0" "duty cycle";
+
+static_assert(flashStringCount(kSubsystemNames, sizeof(kSubsystemNames)) == kNumWatchdogSubsystems,
+              "every watchdog subsystem needs a name");
+
+WatchdogClass Watchdog;
+
+static uint32_t checksum(const WatchdogClass::Snapshot& snapshot) {
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(&snapshot);
+    uint32_t sum = 0;
+
+    for (int i = 0; i < kSnapshotSizeInWords - 1; ++i) {
+        sum = (sum << 1 | sum >> 31) ^ words[i];
+    }
+
+    return sum;
+}
+
+WatchdogClass::WatchdogClass(): _armedMask(0) {
+    for (int i = 0; i < kNumWatchdogSubsystems; ++i) {
+        _budgetMillis[i] = 0;
+        _deadlineMillis[i] = 0;
+    }
+}
+
+void WatchdogClass::begin() {
+    _ticker.attach(1, check);
+}
+
+void WatchdogClass::arm(WatchdogSubsystem subsystem, const TimeInterval& budget) {
+    _budgetMillis[subsystem] = budget.milliseconds();
+    _deadlineMillis[subsystem] = millis() + _budgetMillis[subsystem];
+    _armedMask |= 1 << subsystem;
+}
+
+void WatchdogClass::feed(WatchdogSubsystem subsystem) {
+    _deadlineMillis[subsystem] = millis() + _budgetMillis[subsystem];
+}
+
+void WatchdogClass::disarm(WatchdogSubsystem subsystem) {
+    _armedMask &= ~(1 << subsystem);
+}
+
+const __FlashStringHelper* WatchdogClass::subsystemName(uint8_t subsystem) {
+    return subsystem < kNumWatchdogSubsystems ? flashStringAt(kSubsystemNames, subsystem) : F("?");
+}
+
+const __FlashStringHelper* WatchdogClass::systemWatchdogName() {
+    switch (ESP.getResetInfoPtr()->reason) {
+        case REASON_SOFT_WDT_RST:
+            return F("software");
+        case REASON_WDT_RST:
+            return F("hardware");
+        default:
+            return nullptr;
+    }
+}
+
+// runs in the timer context: no network I/O, no delay, no yield
+void WatchdogClass::check() {
+    uint32_t now = millis();
+
+    for (int i = 0; i < kNumWatchdogSubsystems; ++i) {
+        if (!(Watchdog._armedMask & (1 << i))) {
+            continue;
+        }
+
+        int32_t overdue = int32_t(now - Watchdog._deadlineMillis[i]);
+        if (overdue > 0) {
+            Watchdog.bark(WatchdogSubsystem(i), overdue);
+        }
+    }
+}
+
+void WatchdogClass::bark(WatchdogSubsystem subsystem, uint32_t overdueMillis) {
+    Snapshot snapshot;
+    snapshot.magic = kSnapshotMagic;
+    snapshot.subsystem = subsystem;
+    snapshot.lastStage = Profiler.lastLap();
+    snapshot.openValvesMask = Irrigator.openValvesMask();
+    snapshot.reserved = 0;
+    snapshot.loopCount = Profiler.stats(kProbeLoop).count;
+    snapshot.uptimeMillis = millis();
+    snapshot.overdueMillis = overdueMillis;
+    snapshot.freeHeap = ESP.getFreeHeap();
+    snapshot.maxFreeBlockSize = ESP.getMaxFreeBlockSize();
+    snapshot.checksum = checksum(snapshot);
+
+    ESP.rtcUserMemoryWrite(kRTCWatchdogSnapshot, reinterpret_cast<uint32_t*>(&snapshot), sizeof(snapshot));
+
+    // open valves are closed by the Irrigator as it is constructed on the next boot
+    ESP.reset();
+}
+
+bool WatchdogClass::takeLastSnapshot(Snapshot& snapshot) {
+    if (!ESP.rtcUserMemoryRead(kRTCWatchdogSnapshot, reinterpret_cast<uint32_t*>(&snapshot), sizeof(snapshot))) {
+        return false;
+    }
+
+    bool isValid = snapshot.magic == kSnapshotMagic && snapshot.checksum == checksum(snapshot);
+
+    if (snapshot.magic != 0) {
+        uint32_t cleared = 0;
+        ESP.rtcUserMemoryWrite(kRTCWatchdogSnapshot, &cleared, sizeof(cleared));
+    }
+
+    return isValid;
+}
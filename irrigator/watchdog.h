@@ -0,0 +1,66 @@
+#ifndef __watchdog_h
+#define __watchdog_h
+
+#include <Ticker.h>
+#include <WString.h>
+#include <stdint.h>
+#include "time.h"
+
+typedef enum {
+    kWatchdogLoop = 0,
+    kWatchdogDutyCycle,
+
+    kNumWatchdogSubsystems
+} WatchdogSubsystem;
+
+// Each long-running subsystem arms its own heartbeat with a budget and feeds it
+// while it makes progress. A timer checks the heartbeats every second; when one
+// is overdue, the state of the board is saved to RTC memory and the board is
+// reset. The snapshot is reported on the next boot.
+class WatchdogClass {
+public:
+    struct Snapshot {
+        uint32_t magic;
+        uint8_t subsystem;
+        // the last loop stage completed before the stall, see ProfilerProbe
+        uint8_t lastStage;
+        uint8_t openValvesMask;
+        uint8_t reserved;
+        uint32_t loopCount;
+        uint32_t uptimeMillis;
+        uint32_t overdueMillis;
+        uint32_t freeHeap;
+        uint32_t maxFreeBlockSize;
+        uint32_t checksum;
+    };
+
+public:
+    WatchdogClass();
+
+    void begin();
+
+    void arm(WatchdogSubsystem subsystem, const TimeInterval& budget);
+    void feed(WatchdogSubsystem subsystem);
+    void disarm(WatchdogSubsystem subsystem);
+
+    // loads and clears the snapshot left by a stall before the last reset
+    bool takeLastSnapshot(Snapshot& snapshot);
+    // the SDK watchdog that reset the board, if any. A loop that spins without yielding
+    // starves the timer too, so it is caught by these and leaves no snapshot.
+    static const __FlashStringHelper* systemWatchdogName();
+    static const __FlashStringHelper* subsystemName(uint8_t subsystem);
+
+private:
+    static void check();
+    void bark(WatchdogSubsystem subsystem, uint32_t overdueMillis);
+
+private:
+    Ticker _ticker;
+    volatile uint32_t _budgetMillis[kNumWatchdogSubsystems];
+    volatile uint32_t _deadlineMillis[kNumWatchdogSubsystems];
+    volatile uint8_t _armedMask;
+};
+
+extern WatchdogClass Watchdog;
+
+#endif // __watchdog_h
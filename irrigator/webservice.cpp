@@ -1,156 +1,318 @@
 #include <Stream.h>
+#include <stdlib.h>
+#include <string.h>
 #include "webservice.h"
+#include "benchmark.h"
 #include "common.h"
 #include "duty_cycle_manager.h"
+#include "flow_meter.h"
 #include "http_request.h"
+#include "persistence.h"
+#include "power_manager.h"
+#include "profiler.h"
+#include "response_cache.h"
+#include "scheduler.h"
+#include "static_assets.h"
+#include "str_builder.h"
+#include "str_view.h"
 #include "string_ext.h"
+#include "syslog.h"
 #include "time.h"
+#include "valve_queue.h"
 
-static const char kWebserviceCredentials[] = "*:*";
-
-static String renderTaskForm(const DutyCycleManagerClass::Task& task) {
-    String form = F("<form method=\"post\" action=\"/valve/");
-    form += String(task.valve + 1);
-    form += F("/\"><h3><input type=\"checkbox\" name=\"is_enabled\"");
-    if (task.isEnabled) {
-        form += F(" checked=\"checked\"");
-    }
-    form += F("/> Valve ");
-    form += String(task.valve + 1);
-    form += F("</h3><p>Description: <input type=\"text\" name=\"description\" maxlength=\"");
-    form += String(DutyCycleManagerClass::Task::kDescriptionMaxLength);
-    form += F("\" value=\"");
-    form += task.description;
-    form += F("\"/><br/>");
-    form += F("Duration: <input type=\"text\" name=\"duration\" value=\"");
-    form += task.duration;
-    form += F("\"/>sec</p>");
-    form += F("<p><input type=\"submit\" value=\"Apply\"/></p></form>");
-    return form;
-}
-
-static String renderStatusPage() {
-    String page = F("HTTP/1.1 200 OK\r\n");
-    page += F("Content-Type: text/html\r\n\r\n");
-    page += F("<!DOCTYPE HTML><html><title>Irrigator</title><body><h1>Irrigator Status</h1>");
-    page += F("<p>Last cycle executed: ");
-    page += DutyCycleManager.timeIntervalSinceLastCycle().toHumanReadableString();
-    page += F(" ago<br/>Next cycle due: in ");
-    page += DutyCycleManager.timeIntervalTillNextCycle().toHumanReadableString();
-    page += F("</p>");
-
-    page += F("<p>");
-    page += F("<form method=\"post\" action=\"/reset/\">");
-    page += F("<input type=\"submit\" value=\"Reset\"/>");
-    page += F("</form><br/>");
-    page += F("<form method=\"post\" action=\"/reschedule/\">");
-    page += F("<input type=\"hidden\" name=\"delay\" value=\"0\"/>");
-    page += F("<input type=\"submit\" value=\"Run now\"/>");
-    page += F("</form><br/>");
-    page += F("<form method=\"post\" action=\"/reschedule/\">");
-    page += F("Schedule next cycle: <input type=\"text\" name=\"delay\" value=\"600\"/> seconds from now");
-    page += F("<input type=\"submit\" value=\"Schedule\"/>");
-    page += F("</form>");
-    page += F("<p>");
-    page += F("<form method=\"post\" action=\"/set_interval/\">");
-    page += String(F("Cycle interval: <input type=\"text\" name=\"hours\" value=\"")) + 
-        String(DutyCycleManager.cycleInterval().seconds() / 3600) + 
-        F("\"/> hours");
-    page += F("<input type=\"submit\" value=\"Set interval\"/>");
-    page += F("</form><br/>");
-    page += F("</p>");
+static const char kWebserviceCredentials[] PROGMEM = "*:*";
 
+typedef enum {
+    kRouteValve = 0,
+    kRouteRunValve,
+    kRouteQueue,
+    kRouteReset,
+    kRouteReschedule,
+    kRouteSetInterval,
+    kRouteLog,
+    kRouteMetrics,
+    kRouteStatus,
+    kRouteAsset,
+    kRouteBenchmark,
+    kRouteLoad,
+    kRouteNotFound,
+
+    kNumRoutes
+} Route;
+
+static constexpr char kRouteNames[] PROGMEM =
+    "valve\0" "run_valve\0" "queue\0" "reset\0" "reschedule\0" "set_interval\0" "log\0" "metrics\0" "status\0"
+    "asset\0" "benchmark\0" "load\0" "not_found";
+
+static_assert(flashStringCount(kRouteNames, sizeof(kRouteNames)) == kNumRoutes,
+              "every route needs a name");
+
+static uint32_t requestCounts[kNumRoutes];
+
+// Collects small writes into TCP segment sized chunks. The logger prints
+// character by character, which would otherwise turn into a write per byte.
+class ChunkedPrint: public Print {
+public:
+    ChunkedPrint(Print& output): _output(output), _length(0) {}
+    ~ChunkedPrint() { flush(); }
+
+    virtual size_t write(uint8_t ch) {
+        if (_length == kChunkSize) {
+            flush();
+        }
+        _chunk[_length++] = ch;
+        return 1;
+    }
+
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        for (size_t i = 0; i < size;) {
+            if (_length == kChunkSize) {
+                flush();
+            }
+            size_t length = size - i < size_t(kChunkSize - _length) ? size - i : kChunkSize - _length;
+            memcpy(_chunk + _length, buffer + i, length);
+            _length += length;
+            i += length;
+        }
+        return size;
+    }
+
+    void flush() {
+        if (_length > 0) {
+            _output.write(_chunk, _length);
+            _length = 0;
+        }
+    }
+
+private:
+    static const int kChunkSize = 256;
+
+    Print& _output;
+    uint8_t _chunk[kChunkSize];
+    int _length;
+};
+
+static void writeTaskJSON(Print& output, const DutyCycleManagerClass::Task& task) {
+    output.print(F("{\"valve\":"));
+    output.print(task.valve + 1);
+    output.print(F(",\"enabled\":"));
+    output.print(task.isEnabled ? F("true") : F("false"));
+    output.print(F(",\"description\":"));
+    writeJSONString(task.description, strnlen(task.description, sizeof(task.description)), output);
+    output.print(F(",\"duration_s\":"));
+    output.print(task.duration);
+    output.print(F(",\"volume_ml\":"));
+    output.print(uint32_t(task.volumeDecilitres) * 100);
+    output.print('}');
+}
+
+static void writeTimeIntervalJSON(Print& output, const TimeInterval& interval) {
+    char formatted[TimeInterval::kMaxFormattedLength];
+    size_t length = interval.format(formatted, sizeof(formatted));
+    writeJSONString(formatted, length, output);
+}
+
+// the part of the status that changes only with the duty cycle generation
+static void writeSettingsJSON(Print& output) {
+    output.print(F("\"interval_h\":"));
+    output.print(DutyCycleManager.cycleInterval().seconds() / 3600);
+    output.print(F(",\"flow_meter\":"));
+    output.print(FlowMeter.isEnabled() ? F("true") : F("false"));
+    output.print(F(",\"description_max_length\":"));
+    output.print(DutyCycleManagerClass::Task::kDescriptionMaxLength);
+
+    output.print(F(",\"valves\":["));
     for (int i = 0; i < kNumOutputValves; ++i) {
-        page += renderTaskForm(DutyCycleManager.task(i));
+        if (i > 0) {
+            output.print(',');
+        }
+        writeTaskJSON(output, DutyCycleManager.task(i));
+    }
+    output.print(']');
+}
+
+void writeStatusJSON(Print& output) {
+    output.print(F("HTTP/1.1 200 OK\r\n"));
+    output.print(F("Content-Type: application/json\r\n"));
+    output.print(F("Cache-Control: no-store\r\n\r\n"));
+
+    // the cycle times, the queue and the counters move on their own, and are
+    // written around the cached settings
+    output.print(F("{\"last_cycle\":"));
+    writeTimeIntervalJSON(output, DutyCycleManager.timeIntervalSinceLastCycle());
+    output.print(F(",\"next_cycle\":"));
+    writeTimeIntervalJSON(output, DutyCycleManager.timeIntervalTillNextCycle());
+
+    output.print(F(",\"queue\":{\"active\":"));
+    output.print(ValveQueue.isActive() ? F("true") : F("false"));
+    output.print(F(",\"running\":"));
+    output.print(ValveQueue.isRunning() ? F("true") : F("false"));
+    output.print(F(",\"depth\":"));
+    output.print(ValveQueue.depth());
+    output.print(F("},"));
+
+    ResponseCache.write(kRouteStatus, DutyCycleManager.generation(), writeSettingsJSON, output);
+
+    output.print(F(",\"delivered_ml\":["));
+    for (int i = 0; i < kNumOutputValves; ++i) {
+        if (i > 0) {
+            output.print(',');
+        }
+        output.print(FlowMeter.totalMillilitres(DutyCycleManager.task(i).valve));
     }
-    page += F("</body></html>");
-    return page;
+    output.print(']');
+
+    output.print(F(",\"eeprom\":{\"commits\":"));
+    output.print(Persistence.commitCount());
+    output.print(F(",\"failed\":"));
+    output.print(Persistence.failedCommitCount());
+    output.print(F(",\"last_ms\":"));
+    output.print(Persistence.lastCommitLatencyMicros() / 1000);
+    output.print(F(",\"max_ms\":"));
+    output.print(Persistence.maxCommitLatencyMicros() / 1000);
+    output.print('}');
+
+    output.print(F(",\"syslog\":"));
+    if (Syslog.isEnabled()) {
+        output.print(F("{\"sent\":"));
+        output.print(Syslog.sentCount());
+        output.print(F(",\"lost\":"));
+        output.print(Syslog.lostCount());
+        output.print('}');
+    }
+    else {
+        output.print(F("null"));
+    }
+    output.print(F("}\n"));
 }
 
-static String renderUnauthorized() {
-    String page = F("HTTP/1.1 401 Unauthorized\r\n");
-    page += F("WWW-Authenticate: Basic realm=\"Irrigator\"\r\n");
-    page += F("Content-Type: text/html\r\n\r\n");
-    page += F("<html><head><title>401 Unauthorized</title></head><body>");
-    page += F("<h1>Unauthorized</h1></body></html>");
-    return page;
+static void writeUnauthorized(Print& output) {
+    output.print(F("HTTP/1.1 401 Unauthorized\r\n"));
+    output.print(F("WWW-Authenticate: Basic realm=\"Irrigator\"\r\n"));
+    output.print(F("Content-Type: text/html\r\n\r\n"));
+    output.print(F("<html><head><title>401 Unauthorized</title></head><body>"));
+    output.print(F("<h1>Unauthorized</h1></body></html>"));
 }
 
-static String renderRedirectToStatusPage() {
-    String page = F("HTTP/1.1 303 See Other\r\n");
-    page += F("Location: /\r\n\r\n");
-    return page;
+static void writeRedirectToStatusPage(Print& output) {
+    output.print(F("HTTP/1.1 303 See Other\r\n"));
+    output.print(F("Location: /\r\n\r\n"));
 }
 
-static String renderBadRequest() {
-    String page = F("HTTP/1.1 400 Bad Request\r\n");
-    page += F("Content-Type: text/html\r\n\r\n");
-    page += F("<html><head><title>400 Bad Request</title></head><body>");
-    page += F("<h1>Bad Request</h1></body></html>");
-    return page;
+static void writeBadRequest(Print& output) {
+    output.print(F("HTTP/1.1 400 Bad Request\r\n"));
+    output.print(F("Content-Type: text/html\r\n\r\n"));
+    output.print(F("<html><head><title>400 Bad Request</title></head><body>"));
+    output.print(F("<h1>Bad Request</h1></body></html>"));
 }
 
-static String renderNotFound() {
-    String page = F("HTTP/1.1 404 Not Found\r\n");
-    page += F("Content-Type: text/html\r\n\r\n");
-    page += F("<html><head><title>404 Not Found</title></head><body>");
-    page += F("<h1>Not Found</h1></body></html>");
-    return page;
+static void writeNotFound(Print& output, const String& uri) {
+    output.print(F("HTTP/1.1 404 Not Found\r\n"));
+    output.print(F("Content-Type: text/html\r\n\r\n"));
+    output.print(F("<html><head><title>404 Not Found</title></head><body>"));
+    output.print(F("<h1>Not Found</h1><p>"));
+    // the URI comes from the client as it is
+    writeHTMLEscaped(uri.c_str(), uri.length(), output);
+    output.print(F(" is not here.</p><a href=\"/\">Back</a></body></html>"));
 }
 
-static bool isAuthorized(const HTTPRequest& request) {
-    auto it = request.headers().iterator();
-    HTTPHeaderField* field = it.next();
-    while (field) {
-        if (field->name == F("Authorization") && field->value.startsWith("Basic ")) {
-            String credentialsB64;
-            String credentials;
-            bisect(field->value, " ", credentialsB64);
-            if (base64Decode(credentialsB64, credentials) && credentials == kWebserviceCredentials) {
-                return true;
-            }
+// the index of the static asset served at uri, or -1
+static int findStaticAsset(const StrView& uri) {
+    for (int i = 0; i < kNumStaticAssets; ++i) {
+        if (uri == FPSTR(staticAsset(i).path)) {
+            return i;
         }
-        field = it.next();
     }
 
-    return false;
+    return -1;
 }
 
-static void handleUpdateValve(const HTTPRequest& request, Stream& responseStream) {
-    if (!isAuthorized(request)) {
-        responseStream.print(renderUnauthorized());
-        return;
+static bool isAuthorized(const HTTPRequest& request) {
+    static const size_t kMaxCredentialsLength = 64;
+
+    for (const HTTPHeaderField& field : request.headers()) {
+        StrView value(field.value);
+        if (!StrView(field.name).equalsIgnoreCase(F("Authorization")) || !value.startsWith(F("Basic "))) {
+            continue;
+        }
+
+        // decoded on the stack, credentials that do not fit cannot match anyway
+        char buffer[kMaxCredentialsLength];
+        StrBuilder credentials(buffer, sizeof(buffer));
+        Base64Decoder decoder(credentials);
+        StrView encoded = value.substr(6).trim();
+        if (decoder.write(encoded.data(), encoded.length()) && decoder.finish() &&
+            !credentials.isOverflowed() && credentials.view() == FPSTR(kWebserviceCredentials)) {
+            return true;
+        }
     }
 
-    String vstr = request.uri().substring(7, request.uri().length() - 1);
-    int v = vstr.toInt() - 1;
-    bool isInvalidValve = true;
+    return false;
+}
+
+// the output valve addressed by /valve/<n>/..., or -1
+static int valveFromURI(const StrView& uri) {
+    int v = uri.substr(7).toInt() - 1;
 
     for (int i = 0; i < kNumOutputValves; ++i) {
         if (v == outputValves[i]) {
-            isInvalidValve = false;
-            break;
+            return v;
+        }
+    }
+
+    return -1;
+}
+
+static uint16_t parseDecilitres(const StrView& litres) {
+    float value = litres.toFloat();
+    return value > 0 && value < 6553.5 ? uint16_t(value * 10 + 0.5f) : 0;
+}
+
+// a whole number of seconds, 1 to 65535, in digits only; -1 otherwise
+static int32_t parseSeconds(const StrView& seconds) {
+    if (seconds.length() == 0 || seconds.length() > 5) {
+        return -1;
+    }
+    for (size_t i = 0; i < seconds.length(); ++i) {
+        if (seconds[i] < '0' || seconds[i] > '9') {
+            return -1;
         }
     }
 
-    if (isInvalidValve) {
-        LOG(String(F("bad request: ")) + request.method() + " " + request.uri() + "\n");
-        responseStream.print(renderBadRequest());
+    int32_t value = int32_t(seconds.toUInt());
+    return value >= 1 && value <= UINT16_MAX ? value : -1;
+}
+
+static void handleUpdateValve(const HTTPRequest& request, Stream& responseStream) {
+    if (!isAuthorized(request)) {
+        writeUnauthorized(responseStream);
+        return;
+    }
+
+    int v = valveFromURI(request.uri());
+    if (v < 0) {
+        LOG_WARNING(WebService, "bad request: %s %s\n", request.method(), request.uri());
+        writeBadRequest(responseStream);
         return;
     }
 
     // parse valve settings
     HTTPForm form(request.body());
-    DutyCycleManagerClass::Task task;
+    // unchecked boxes send nothing, and the whole record is compared when saved
+    DutyCycleManagerClass::Task task = {};
     task.valve = (Valve)v;
+    task.volumeDecilitres = DutyCycleManager.task(v).volumeDecilitres;
 
     for (int i = 0; i < form.fieldCount(); ++i) {
         if (form.field(i).name == F("description")) {
-            form.field(i).value.toCharArray(task.description, DutyCycleManagerClass::Task::kDescriptionMaxLength);
+            form.field(i).value.copyTo(task.description, sizeof(task.description));
         } 
         else if (form.field(i).name == F("duration")) {
             task.duration = form.field(i).value.toInt();
         } 
+        else if (form.field(i).name == F("volume")) {
+            task.volumeDecilitres = parseDecilitres(form.field(i).value);
+        }
         else if (form.field(i).name == F("is_enabled")) {
             task.isEnabled = true;
         }
@@ -159,23 +321,129 @@ static void handleUpdateValve(const HTTPRequest& request, Stream& responseStream
     // apply settings
     DutyCycleManager.updateTask(task);
 
-    responseStream.print(renderRedirectToStatusPage());
+    writeRedirectToStatusPage(responseStream);
+}
+
+static void handleRunValve(const HTTPRequest& request, Stream& responseStream) {
+    if (!isAuthorized(request)) {
+        writeUnauthorized(responseStream);
+        return;
+    }
+
+    int v = valveFromURI(request.uri());
+    if (v < 0) {
+        LOG_WARNING(WebService, "bad request: %s %s\n", request.method(), request.uri());
+        writeBadRequest(responseStream);
+        return;
+    }
+
+    IrrigatorClass::Task task = {};
+    task.valve = (Valve)v;
+    task.duration = 0;
+    task.volumeDecilitres = 0;
+
+    // this opens a valve: a duration out of range or with trailing units is
+    // refused, rather than wrapped around or cut short
+    int32_t duration = -1;
+    HTTPForm form(request.body());
+    for (int i = 0; i < form.fieldCount(); ++i) {
+        if (form.field(i).name == F("duration")) {
+            duration = parseSeconds(form.field(i).value);
+        }
+        else if (form.field(i).name == F("volume")) {
+            task.volumeDecilitres = parseDecilitres(form.field(i).value);
+        }
+    }
+
+    if (duration < 0) {
+        LOG_WARNING(WebService, "bad request: %s %s\n", request.method(), request.uri());
+        writeBadRequest(responseStream);
+        return;
+    }
+    task.duration = duration;
+
+    uint16_t id = ValveQueue.post(task);
+    if (id == 0) {
+        responseStream.print(F("HTTP/1.1 503 Service Unavailable\r\n"));
+        responseStream.print(F("Retry-After: "));
+        responseStream.print(Irrigator.timeIntervalTillUpdate().seconds() + 1);
+        responseStream.print(F("\r\nContent-Type: text/html\r\n\r\n"));
+        responseStream.print(F("<html><body><h1>Command queue is full</h1><a href=\"/\">Back</a></body></html>"));
+        return;
+    }
+
+    // the command runs from the loop, the client follows it through /queue/
+    responseStream.print(F("HTTP/1.1 202 Accepted\r\n"));
+    responseStream.print(F("Location: /queue/\r\n"));
+    responseStream.print(F("Content-Type: text/html\r\n\r\n"));
+    responseStream.print(F("<html><body><h1>Queued as command #"));
+    responseStream.print(id);
+    responseStream.print(F("</h1><a href=\"/queue/\">Queue</a> <a href=\"/\">Back</a></body></html>"));
+}
+
+static void writeCommandJSON(Print& output, const ValveQueueClass::Command& command) {
+    output.print(F("{\"id\":"));
+    output.print(command.id);
+    output.print(F(",\"valve\":"));
+    output.print(command.task.valve + 1);
+    output.print(F(",\"duration_s\":"));
+    output.print(command.task.duration);
+    output.print(F(",\"volume_ml\":"));
+    output.print(uint32_t(command.task.volumeDecilitres) * 100);
+}
+
+static void handleQueueQuery(const HTTPRequest& request, Stream& responseStream) {
+    responseStream.print(F("HTTP/1.1 200 OK\r\n"));
+    responseStream.print(F("Content-Type: application/json\r\n\r\n"));
+
+    ChunkedPrint output(responseStream);
+    output.print(F("{\"depth\":"));
+    output.print(ValveQueue.depth());
+    output.print(F(",\"capacity\":"));
+    output.print(ValveQueueClass::kCapacity);
+    output.print(F(",\"completed\":"));
+    output.print(ValveQueue.completedCount());
+    output.print(F(",\"rejected\":"));
+    output.print(ValveQueue.rejectedCount());
+
+    output.print(F(",\"running\":"));
+    if (ValveQueue.isRunning()) {
+        writeCommandJSON(output, ValveQueue.runningCommand());
+        output.print(F(",\"elapsed_ms\":"));
+        output.print(Irrigator.activeTaskElapsedMillis());
+        output.print(F(",\"delivered_ml\":"));
+        output.print(Irrigator.activeTaskMillilitres());
+        output.print('}');
+    }
+    else {
+        output.print(F("null"));
+    }
+
+    output.print(F(",\"pending\":["));
+    for (int i = 0; i < ValveQueue.depth(); ++i) {
+        if (i > 0) {
+            output.print(',');
+        }
+        writeCommandJSON(output, ValveQueue.pendingCommand(i));
+        output.print('}');
+    }
+    output.print(F("]}\n"));
 }
 
 static void handleResetDutyCycle(const HTTPRequest& request, Stream& responseStream) {
     if (!isAuthorized(request)) {
-        responseStream.print(renderUnauthorized());
+        writeUnauthorized(responseStream);
         return;
     }
 
     DutyCycleManager.reset();
 
-    responseStream.print(renderRedirectToStatusPage());
+    writeRedirectToStatusPage(responseStream);
 }
 
 static void handleRescheduleDutyCycle(const HTTPRequest& request, Stream& responseStream) {
     if (!isAuthorized(request)) {
-        responseStream.print(renderUnauthorized());
+        writeUnauthorized(responseStream);
         return;
     }
 
@@ -192,17 +460,17 @@ static void handleRescheduleDutyCycle(const HTTPRequest& request, Stream& respon
         DutyCycleManager.schedule(TimeInterval::withSeconds(delay));
     }
     else {
-        LOG(String(F("bad request: ")) + request.method() + " " + request.uri() + "\n");
-        responseStream.print(renderBadRequest());
+        LOG_WARNING(WebService, "bad request: %s %s\n", request.method(), request.uri());
+        writeBadRequest(responseStream);
         return;
     }
 
-    responseStream.print(renderRedirectToStatusPage());
+    writeRedirectToStatusPage(responseStream);
 }
 
 static void handleSetCycleInterval(const HTTPRequest& request, Stream& responseStream) {
     if (!isAuthorized(request)) {
-        responseStream.print(renderUnauthorized());
+        writeUnauthorized(responseStream);
         return;
     }
 
@@ -219,37 +487,254 @@ static void handleSetCycleInterval(const HTTPRequest& request, Stream& responseS
         DutyCycleManager.setCycleInterval(TimeInterval::withSeconds(60 * 60 * hours));
     }
     else {
-        LOG(String(F("bad request: ")) + request.method() + " " + request.uri() + "\n");
-        responseStream.print(renderBadRequest());
+        LOG_WARNING(WebService, "bad request: %s %s\n", request.method(), request.uri());
+        writeBadRequest(responseStream);
+        return;
+    }
+
+    writeRedirectToStatusPage(responseStream);
+}
+
+// GET /log/?since=<cursor> returns the records logged since the cursor, or the whole
+// ring if it is omitted, and the cursor to pass on the next request in X-Log-Cursor.
+static void handleLogQuery(const HTTPRequest& request, Stream& responseStream) {
+    if (!isAuthorized(request)) {
+        writeUnauthorized(responseStream);
         return;
     }
 
-    responseStream.print(renderRedirectToStatusPage());
+    uint32_t cursor = Logger.firstSequence();
+    uint32_t until = Logger.nextSequence();
+
+    HTTPForm form(request.query());
+    for (int i = 0; i < form.fieldCount(); ++i) {
+        if (form.field(i).name == F("since")) {
+            cursor = form.field(i).value.toUInt();
+            break;
+        }
+    }
+
+    // a cursor from the future was handed out before the last reboot
+    if (int32_t(cursor - until) > 0) {
+        cursor = Logger.firstSequence();
+    }
+
+    responseStream.print(F("HTTP/1.1 200 OK\r\n"));
+    responseStream.print(F("Content-Type: text/plain\r\n"));
+    responseStream.print(F("X-Log-Cursor: "));
+    responseStream.print(until);
+    responseStream.print(F("\r\n\r\n"));
+
+    ChunkedPrint output(responseStream);
+    Logger.print(output, cursor, until);
+}
+
+static void handleMetricsQuery(const HTTPRequest& request, Stream& responseStream) {
+    responseStream.print(F("HTTP/1.1 200 OK\r\n"));
+    responseStream.print(F("Content-Type: text/plain; version=0.0.4\r\n\r\n"));
+
+    ChunkedPrint output(responseStream);
+    Profiler.writeMetrics(output);
+
+    output.print(F("# TYPE irrigator_http_requests_total counter\n"));
+    for (int i = 0; i < kNumRoutes; ++i) {
+        output.print(F("irrigator_http_requests_total{route=\""));
+        output.print(flashStringAt(kRouteNames, i));
+        output.print(F("\"} "));
+        output.print(requestCounts[i]);
+        output.print('\n');
+    }
+
+    output.print(F("# TYPE irrigator_response_cache_hits_total counter\nirrigator_response_cache_hits_total "));
+    output.print(ResponseCache.hitCount());
+    output.print(F("\n# TYPE irrigator_response_cache_misses_total counter\nirrigator_response_cache_misses_total "));
+    output.print(ResponseCache.missCount());
+    output.print('\n');
+
+    output.print(F("# TYPE irrigator_sleep_seconds_total counter\nirrigator_sleep_seconds_total "));
+    output.print(uint32_t(Scheduler.totalSleepMillis() / 1000));
+    output.print('\n');
+
+    // deep sleep resets the board, so only the modem and light sleep counters grow
+    output.print(F("# TYPE irrigator_power_mode_seconds_total counter\n"));
+    for (int i = 0; i < kNumPowerModes; ++i) {
+        output.print(F("irrigator_power_mode_seconds_total{mode=\""));
+        output.print(PowerManagerClass::modeName(PowerMode(i)));
+        output.print(F("\"} "));
+        output.print(uint32_t(PowerManager.millisInMode(PowerMode(i)) / 1000));
+        output.print('\n');
+    }
+
+    if (FlowMeter.isEnabled()) {
+        output.print(F("# TYPE irrigator_valve_volume_litres_total counter\n"));
+        for (int i = 0; i < kNumOutputValves; ++i) {
+            uint32_t millilitres = FlowMeter.totalMillilitres(outputValves[i]);
+            output.print(F("irrigator_valve_volume_litres_total{valve=\""));
+            output.print(outputValves[i] + 1);
+            output.print(F("\"} "));
+            output.print(millilitres / 1000);
+            output.print('.');
+            output.print(char('0' + millilitres / 100 % 10));
+            output.print(char('0' + millilitres / 10 % 10));
+            output.print(char('0' + millilitres % 10));
+            output.print('\n');
+        }
+    }
 }
 
+#if DEBUG
+static void handleBenchmarkQuery(const HTTPRequest& request, Stream& responseStream) {
+    if (!isAuthorized(request)) {
+        writeUnauthorized(responseStream);
+        return;
+    }
+
+    responseStream.print(F("HTTP/1.1 200 OK\r\n"));
+    responseStream.print(F("Content-Type: application/json\r\n\r\n"));
+
+    ChunkedPrint output(responseStream);
+    runBenchmarks(output);
+}
+
+static void handleLoadQuery(const HTTPRequest& request, Stream& responseStream) {
+    if (!isAuthorized(request)) {
+        writeUnauthorized(responseStream);
+        return;
+    }
+
+    int requestCount = 100;
+    HTTPForm form(request.query());
+    for (int i = 0; i < form.fieldCount(); ++i) {
+        if (form.field(i).name == F("requests")) {
+            requestCount = form.field(i).value.toInt();
+        }
+    }
+    if (requestCount <= 0) {
+        writeBadRequest(responseStream);
+        return;
+    }
+
+    responseStream.print(F("HTTP/1.1 200 OK\r\n"));
+    responseStream.print(F("Content-Type: application/json\r\n\r\n"));
+
+    ChunkedPrint output(responseStream);
+    runLoad(request, requestCount, output);
+}
+#endif
+
 static void handleStatusQuery(const HTTPRequest& request, Stream& responseStream) {
-    responseStream.print(renderStatusPage());
+    ChunkedPrint output(responseStream);
+    writeStatusJSON(output);
+}
+
+// whether the client already has this version of the asset cached
+static bool isNotModified(const HTTPRequest& request, const StaticAsset& asset) {
+    char etag[24];
+    size_t length = copyFromFlash(etag, sizeof(etag), FPSTR(asset.etag));
+    if (length >= sizeof(etag)) {
+        return false;
+    }
+
+    for (const HTTPHeaderField& field : request.headers()) {
+        if (StrView(field.name).equalsIgnoreCase(F("If-None-Match")) &&
+            StrView(field.value).find(StrView(etag, length)) != StrView::npos) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Assets are only kept gzipped. Every browser accepts that, so the encoding is
+// not negotiated.
+static void handleStaticAsset(const HTTPRequest& request, const StaticAsset& asset, Stream& responseStream) {
+    bool isCached = isNotModified(request, asset);
+
+    responseStream.print(isCached ? F("HTTP/1.1 304 Not Modified\r\n") : F("HTTP/1.1 200 OK\r\n"));
+    responseStream.print(F("ETag: "));
+    responseStream.print(FPSTR(asset.etag));
+    responseStream.print(asset.isImmutable ?
+        F("\r\nCache-Control: public, max-age=31536000, immutable\r\n") : F("\r\nCache-Control: no-cache\r\n"));
+    if (isCached) {
+        responseStream.print(F("\r\n"));
+        return;
+    }
+
+    responseStream.print(F("Content-Type: "));
+    responseStream.print(FPSTR(asset.contentType));
+    responseStream.print(F("\r\nContent-Encoding: gzip\r\nContent-Length: "));
+    responseStream.print(asset.length);
+    responseStream.print(F("\r\n\r\n"));
+
+    // copied out of flash a chunk at a time, as the connection may not read it directly
+    uint8_t chunk[256];
+    for (uint32_t offset = 0; offset < asset.length; offset += sizeof(chunk)) {
+        size_t length = asset.length - offset < sizeof(chunk) ? asset.length - offset : sizeof(chunk);
+        memcpy_P(chunk, asset.data + offset, length);
+        responseStream.write(chunk, length);
+    }
 }
 
 void handleRequest(const HTTPRequest& request, Stream& responseStream) {
     // route requests
-    if (request.method() == "POST" && request.uri().startsWith("/valve/")) {
+    StrView method(request.method());
+    StrView uri(request.uri());
+    Route route = kRouteNotFound;
+    int asset = -1;
+    if (method == F("POST") && uri.startsWith(F("/valve/")) && uri.endsWith(F("/run/"))) {
+        route = kRouteRunValve;
+        handleRunValve(request, responseStream);
+    }
+    else if (method == F("GET") && uri == F("/queue/")) {
+        route = kRouteQueue;
+        handleQueueQuery(request, responseStream);
+    }
+    else if (method == F("POST") && uri.startsWith(F("/valve/"))) {
+        route = kRouteValve;
         handleUpdateValve(request, responseStream);
     }
-    else if (request.method() == "POST" && request.uri() == "/reset/") {
+    else if (method == F("POST") && uri == F("/reset/")) {
+        route = kRouteReset;
         handleResetDutyCycle(request, responseStream);
     }
-    else if (request.method() == "POST" && request.uri() == "/reschedule/") {
+    else if (method == F("POST") && uri == F("/reschedule/")) {
+        route = kRouteReschedule;
         handleRescheduleDutyCycle(request, responseStream);
     }
-    else if (request.method() == "POST" && request.uri() == "/set_interval/") {
+    else if (method == F("POST") && uri == F("/set_interval/")) {
+        route = kRouteSetInterval;
         handleSetCycleInterval(request, responseStream);
     }
-    else if (request.method() == "GET" && request.uri() == "/") {
+    else if (method == F("GET") && uri == F("/log/")) {
+        route = kRouteLog;
+        handleLogQuery(request, responseStream);
+    }
+    else if (method == F("GET") && uri == F("/metrics")) {
+        route = kRouteMetrics;
+        handleMetricsQuery(request, responseStream);
+    }
+    else if (method == F("GET") && uri == F("/status.json")) {
+        route = kRouteStatus;
         handleStatusQuery(request, responseStream);
     }
+#if DEBUG
+    else if (method == F("GET") && uri == F("/debug/bench/")) {
+        route = kRouteBenchmark;
+        handleBenchmarkQuery(request, responseStream);
+    }
+    else if (method == F("GET") && uri == F("/debug/load/")) {
+        route = kRouteLoad;
+        handleLoadQuery(request, responseStream);
+    }
+#endif
+    else if (method == F("GET") && (asset = findStaticAsset(uri)) >= 0) {
+        route = kRouteAsset;
+        handleStaticAsset(request, staticAsset(asset), responseStream);
+    }
     else {
-        LOG(String(F("not found: ")) + request.method() + " " + request.uri() + "\n");
-        responseStream.print(renderNotFound());
+        LOG_WARNING(WebService, "not found: %s %s\n", request.method(), request.uri());
+        writeNotFound(responseStream, request.uri());
     }
+
+    ++requestCounts[route];
 }
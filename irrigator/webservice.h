@@ -2,8 +2,13 @@
 #define __webservice_h
 
 class HTTPRequest;
+class Print;
 class Stream;
 
 extern void handleRequest(const HTTPRequest& request, Stream& responseStream);
 
+// The data the status page shows, as JSON, headers included. The page itself
+// is a static asset that fetches it.
+extern void writeStatusJSON(Print& output);
+
 #endif // __webservice_h
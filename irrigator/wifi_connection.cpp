@@ -0,0 +1,273 @@
+#include "wifi_connection.h"
+
+#include <EEPROM.h>
+#include <string.h>
+extern "C" {
+#include <lwip/dhcp.h>
+#include <lwip/netif.h>
+#include <user_interface.h>
+}
+#include "clock.h"
+#include "common.h"
+#include "persistence.h"
+#include "profiler.h"
+#include "scheduler.h"
+
+// a cached attempt either associates quickly or not at all
+static const uint32_t kCachedAttemptTimeoutMillis = 3000;
+static const uint32_t kAttemptTimeoutMillis = 10000;
+static const uint32_t kMinBackoffMillis = 500;
+#if DEBUG
+static const uint32_t kMaxBackoffMillis = 30000;
+#else
+static const uint32_t kMaxBackoffMillis = 5 * 60000;
+#endif
+
+WiFiConnectionClass WiFiConnection;
+
+// the lease held by the DHCP client of the station, 0 if there is none
+static uint32_t stationLeaseSeconds() {
+    for (netif* interface = netif_list; interface; interface = interface->next) {
+        if (interface->num == STATION_IF) {
+            const dhcp* client = netif_dhcp_data(interface);
+            return client && client->state == DHCP_STATE_BOUND ? client->offered_t0_lease : 0;
+        }
+    }
+
+    return 0;
+}
+
+WiFiConnectionClass::WiFiConnectionClass():
+    _ssid(nullptr),
+    _password(nullptr),
+    _state(kStateIdle),
+    _isUsingCache(false),
+    _isUsingLease(false),
+    _isLeasePending(false),
+    _leaseSeconds(0),
+    _leaseStartMillis(0),
+    _attemptStartMillis(0),
+    _nextAttemptMillis(0),
+    _backoffMillis(kMinBackoffMillis),
+    _reconnectCount(0),
+    _hasGotIP(false),
+    _wasDisconnected(false) {
+    memset(&_cache, 0, sizeof(_cache));
+}
+
+void WiFiConnectionClass::begin(const char* ssid, const char* password) {
+    _ssid = ssid;
+    _password = password;
+
+    // the SDK would otherwise rewrite its own flash config on every WiFi.begin()
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+
+    // called from the SDK event context, keep them short
+    _gotIPHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP& event) {
+        _hasGotIP = true;
+    });
+    _disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected& event) {
+        _wasDisconnected = true;
+    });
+
+    loadCache();
+    connect();
+}
+
+void WiFiConnectionClass::maintain() {
+    uint32_t now = millis();
+
+    switch (_state) {
+        case kStateConnecting:
+            if (_hasGotIP) {
+                handleConnected();
+            }
+            // the SDK reports a disconnect for every failed try within an attempt and
+            // keeps retrying, so only the timeout ends an attempt
+            else if (now - _attemptStartMillis > (_isUsingCache ? kCachedAttemptTimeoutMillis : kAttemptTimeoutMillis)) {
+                handleFailure();
+            }
+            break;
+
+        case kStateConnected:
+            if (_wasDisconnected) {
+                LOG_WARNING(Main, "WiFi connection lost\n");
+                ++_reconnectCount;
+                _backoffMillis = kMinBackoffMillis;
+                connect();
+            }
+            else if (_isLeasePending && !Clock.isIsolated()) {
+                recordLeaseRenewalTime();
+            }
+            else if (_isUsingLease && !isLeaseUsable()) {
+                renewLease();
+            }
+            break;
+
+        case kStateBackingOff:
+            if (int32_t(now - _nextAttemptMillis) >= 0) {
+                connect();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+TimeInterval WiFiConnectionClass::timeIntervalTillNextAttempt() const {
+    uint32_t now = millis();
+
+    switch (_state) {
+        case kStateConnecting: {
+            uint32_t timeoutMillis = _isUsingCache ? kCachedAttemptTimeoutMillis : kAttemptTimeoutMillis;
+            return TimeInterval::withMilliseconds(int32_t(_attemptStartMillis + timeoutMillis - now) + 1);
+        }
+
+        case kStateBackingOff:
+            return TimeInterval::withMilliseconds(int32_t(_nextAttemptMillis - now));
+
+        case kStateConnected:
+            if (_isUsingLease) {
+                UnixTime renewalTime(_cache.leaseRenewalTime);
+                return renewalTime.timeIntervalSince(Clock.unixTimeFromDeviceTime(Clock.deviceTimeSnapshot()));
+            }
+            return SchedulerClass::noDeadline();
+
+        default:
+            return SchedulerClass::noDeadline();
+    }
+}
+
+bool WiFiConnectionClass::hasPendingEvent() const {
+    return (_state == kStateConnecting && _hasGotIP) || (_state == kStateConnected && _wasDisconnected);
+}
+
+bool WiFiConnectionClass::waitForConnection(const TimeInterval& timeout) {
+    uint32_t startMillis = millis();
+
+    while (!isConnected() && millis() - startMillis < uint32_t(timeout.milliseconds())) {
+        maintain();
+        delay(10);
+    }
+
+    return isConnected();
+}
+
+void WiFiConnectionClass::connect() {
+    _isUsingCache = _cache.isValid;
+    _isUsingLease = _isUsingCache && isLeaseUsable();
+    _isLeasePending = false;
+    _hasGotIP = false;
+    _wasDisconnected = false;
+    _attemptStartMillis = millis();
+    _state = kStateConnecting;
+
+    if (_isUsingLease) {
+        LOG_INFO(Main, "Connecting to %s on channel %u with cached lease\n", _ssid, _cache.channel);
+        WiFi.config(IPAddress(_cache.address), IPAddress(_cache.gateway), IPAddress(_cache.subnetMask),
+                    IPAddress(_cache.dns));
+        WiFi.begin(_ssid, _password, _cache.channel, _cache.bssid);
+    }
+    else if (_isUsingCache) {
+        LOG_INFO(Main, "Connecting to %s on channel %u\n", _ssid, _cache.channel);
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+        WiFi.begin(_ssid, _password, _cache.channel, _cache.bssid);
+    }
+    else {
+        LOG_INFO(Main, "Connecting to %s\n", _ssid);
+        // all zeros switches back to DHCP
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+        WiFi.begin(_ssid, _password);
+    }
+}
+
+void WiFiConnectionClass::handleConnected() {
+    uint32_t elapsedMillis = millis() - _attemptStartMillis;
+    Profiler.record(kProbeCallWiFiConnect, elapsedMillis * 1000);
+    LOG_INFO(Main, "WiFi connected in %ums\n", elapsedMillis);
+
+    _state = kStateConnected;
+    _backoffMillis = kMinBackoffMillis;
+    _wasDisconnected = false;
+
+    if (!_isUsingLease) {
+        saveCache();
+    }
+}
+
+void WiFiConnectionClass::handleFailure() {
+    // stop the SDK from retrying on its own
+    WiFi.disconnect();
+
+    if (_isUsingCache) {
+        LOG_WARNING(Main, "Couldn't connect with cached parameters, scanning\n");
+        // persisted, or every boot would try the same parameters first
+        _cache.isValid = false;
+        _cache.leaseRenewalTime = 0;
+        Persistence.put(PersistenceClass::kSubsystemWiFi, kEEWiFiCache, _cache);
+        connect();
+        return;
+    }
+
+    LOG_ERROR(Main, "Couldn't connect to WiFi, retrying in %ums\n", _backoffMillis);
+    _state = kStateBackingOff;
+    _nextAttemptMillis = millis() + _backoffMillis;
+    _backoffMillis = _backoffMillis * 2 < kMaxBackoffMillis ? _backoffMillis * 2 : kMaxBackoffMillis;
+}
+
+bool WiFiConnectionClass::isLeaseUsable() const {
+    if (_cache.leaseRenewalTime == 0 || Clock.isIsolated()) {
+        return false;
+    }
+
+    return Clock.unixTimeFromDeviceTime(Clock.deviceTimeSnapshot()) < UnixTime(_cache.leaseRenewalTime);
+}
+
+// The lease comes before network time on a cold boot, so it is timed by millis()
+// and converted once the clock has synced.
+void WiFiConnectionClass::recordLeaseRenewalTime() {
+    uint32_t elapsedSeconds = (millis() - _leaseStartMillis) / 1000;
+    _cache.leaseRenewalTime = Clock.unixTime().seconds() - elapsedSeconds + _leaseSeconds / 2;
+    _isLeasePending = false;
+
+    LOG_INFO(Main, "DHCP lease of %us cached\n", _leaseSeconds);
+    Persistence.put(PersistenceClass::kSubsystemWiFi, kEEWiFiCache, _cache);
+}
+
+void WiFiConnectionClass::renewLease() {
+    LOG_INFO(Main, "Cached lease is due for renewal, reconnecting with DHCP\n");
+    _cache.leaseRenewalTime = 0;
+    Persistence.put(PersistenceClass::kSubsystemWiFi, kEEWiFiCache, _cache);
+
+    WiFi.disconnect();
+    connect();
+}
+
+void WiFiConnectionClass::loadCache() {
+    EEPROM.get(kEEWiFiCache, _cache);
+}
+
+void WiFiConnectionClass::saveCache() {
+    memcpy(_cache.bssid, WiFi.BSSID(), sizeof(_cache.bssid));
+    _cache.channel = WiFi.channel();
+    _cache.isValid = true;
+    _cache.address = WiFi.localIP();
+    _cache.subnetMask = WiFi.subnetMask();
+    _cache.gateway = WiFi.gatewayIP();
+    _cache.dns = WiFi.dnsIP();
+    _cache.leaseRenewalTime = 0;
+
+    _leaseSeconds = stationLeaseSeconds();
+    _leaseStartMillis = millis();
+    _isLeasePending = _leaseSeconds > 0;
+    if (_isLeasePending && !Clock.isIsolated()) {
+        recordLeaseRenewalTime();
+        return;
+    }
+
+    // written only if anything changed, so reconnecting to the same AP costs no flash wear
+    Persistence.put(PersistenceClass::kSubsystemWiFi, kEEWiFiCache, _cache);
+}
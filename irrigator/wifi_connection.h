@@ -0,0 +1,95 @@
+#ifndef __wifi_connection_h
+#define __wifi_connection_h
+
+#include <ESP8266WiFi.h>
+#include <stdint.h>
+#include "time.h"
+
+// Keeps the station connected without blocking the loop. The SDK reports
+// connection changes through event callbacks, which only raise flags; maintain()
+// acts on them from the loop and retries attempts that time out with exponential
+// backoff.
+//
+// The BSSID, channel and DHCP lease of the last connection are cached in EEPROM.
+// With the cache, association skips the scan. While the lease is in its first
+// half, which needs network time to tell, the address is also configured
+// statically, which saves the DHCP round trip; once it is due for renewal the
+// station reconnects with DHCP, as a static address is never renewed. If a cached
+// attempt fails, e.g. because the AP moved to another channel, the cache is
+// dropped and the next attempt scans and uses DHCP.
+class WiFiConnectionClass {
+public:
+#pragma pack(push, 1)
+    struct Cache {
+        uint8_t bssid[6];
+        uint8_t channel;
+        bool isValid;
+        uint32_t address;
+        uint32_t subnetMask;
+        uint32_t gateway;
+        uint32_t dns;
+        // Unix time at which the lease is half over, 0 if unknown
+        uint32_t leaseRenewalTime;
+    };
+#pragma pack(pop)
+
+public:
+    WiFiConnectionClass();
+
+    void begin(const char* ssid, const char* password);
+    void maintain();
+
+    // keeps maintaining the connection until it is up or the timeout expires
+    bool waitForConnection(const TimeInterval& timeout);
+
+    bool isConnected() const { return _state == kStateConnected; }
+
+    // time till maintain() has to check on a pending attempt or start a new one
+    TimeInterval timeIntervalTillNextAttempt() const;
+    // set from the SDK events, maintain() has to act on them
+    bool hasPendingEvent() const;
+    uint32_t reconnectCount() const { return _reconnectCount; }
+
+private:
+    typedef enum {
+        kStateIdle = 0,
+        kStateConnecting,
+        kStateConnected,
+        kStateBackingOff
+    } State;
+
+private:
+    void connect();
+    void handleConnected();
+    void handleFailure();
+    bool isLeaseUsable() const;
+    void recordLeaseRenewalTime();
+    void renewLease();
+    void loadCache();
+    void saveCache();
+
+private:
+    const char* _ssid;
+    const char* _password;
+    State _state;
+    Cache _cache;
+    bool _isUsingCache;
+    bool _isUsingLease;
+    // a DHCP lease waiting for network time to be cached
+    bool _isLeasePending;
+    uint32_t _leaseSeconds;
+    uint32_t _leaseStartMillis;
+    uint32_t _attemptStartMillis;
+    uint32_t _nextAttemptMillis;
+    uint32_t _backoffMillis;
+    uint32_t _reconnectCount;
+
+    WiFiEventHandler _gotIPHandler;
+    WiFiEventHandler _disconnectedHandler;
+    volatile bool _hasGotIP;
+    volatile bool _wasDisconnected;
+};
+
+extern WiFiConnectionClass WiFiConnection;
+
+#endif // __wifi_connection_h
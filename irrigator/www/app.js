@@ -0,0 +1,76 @@
+'use strict';
+
+// Fills the page in from /status.json. The page itself is static and cached, so
+// this is all that crosses the network on a revisit.
+
+function $(id) {
+    return document.getElementById(id);
+}
+
+function litres(millilitres) {
+    return (Math.floor(millilitres / 100) / 10).toFixed(1);
+}
+
+function showValve(valve, delivered, status) {
+    const section = $('valve').content.cloneNode(true);
+    const settings = section.querySelector('.settings');
+    const run = section.querySelector('.run');
+
+    settings.action = '/valve/' + valve.valve + '/';
+    settings.elements.is_enabled.checked = valve.enabled;
+    settings.elements.description.maxLength = status.description_max_length;
+    settings.elements.description.value = valve.description;
+    settings.elements.duration.value = valve.duration_s;
+    section.querySelector('.number').textContent = valve.valve;
+
+    run.action = '/valve/' + valve.valve + '/run/';
+    run.elements.duration.value = valve.duration_s;
+
+    if (status.flow_meter) {
+        settings.elements.volume.value = litres(valve.volume_ml);
+        run.elements.volume.value = litres(valve.volume_ml);
+        section.querySelector('.delivered').textContent = litres(delivered);
+    }
+    else {
+        // without the fields the volume is left as it is
+        section.querySelectorAll('.flow').forEach(function (flow) { flow.remove(); });
+    }
+
+    $('valves').appendChild(section);
+}
+
+function show(status) {
+    $('last-cycle').textContent = status.last_cycle;
+    $('next-cycle').textContent = status.next_cycle;
+    $('interval').value = status.interval_h;
+
+    if (status.queue.active) {
+        $('queue').hidden = false;
+        $('queue').querySelector('span').textContent =
+            (status.queue.running ? 'running, ' : 'starting, ') + status.queue.depth + ' pending';
+    }
+
+    status.valves.forEach(function (valve, i) { showValve(valve, status.delivered_ml[i], status); });
+
+    const eeprom = status.eeprom;
+    $('eeprom').textContent = 'EEPROM commits: ' + eeprom.commits + ' (failed: ' + eeprom.failed +
+        ', last: ' + eeprom.last_ms + 'ms, max: ' + eeprom.max_ms + 'ms)';
+
+    if (status.syslog) {
+        $('syslog').hidden = false;
+        $('syslog').textContent = 'Syslog records sent: ' + status.syslog.sent + ' (lost: ' + status.syslog.lost + ')';
+    }
+}
+
+fetch('/status.json')
+    .then(function (response) {
+        if (!response.ok) {
+            throw new Error('server returned ' + response.status);
+        }
+        return response.json();
+    })
+    .then(show)
+    .catch(function (error) {
+        $('error').hidden = false;
+        $('error').textContent = 'Cannot load the status: ' + error.message;
+    });
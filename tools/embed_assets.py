@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Gzips the web UI into flash arrays for the irrigator sketch.
+
+The files in irrigator/www/ become irrigator/static_assets.cpp, which the
+sketch serves with Content-Encoding: gzip. index.html is served at /, every
+other file at /<name>. The page can link the other files as
+
+    <script src="/app.js?v={{hash:app.js}}"></script>
+
+and the placeholder is replaced with the hash of that file, so they can be
+cached for good and a firmware with changed assets still gets fetched anew.
+
+Run it after editing anything in www/; --check fails if static_assets.cpp is
+out of date instead of writing it.
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir, "irrigator")
+SOURCE_DIR = os.path.join(ROOT, "www")
+OUTPUT = os.path.join(ROOT, "static_assets.cpp")
+
+PAGE = "index.html"
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+}
+HASH_PLACEHOLDER = re.compile(rb"\{\{hash:([^}]+)\}\}")
+HASH_LENGTH = 16
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def identifier(name):
+    return "k" + "".join(part.capitalize() for part in re.split(r"[^A-Za-z0-9]+", name) if part)
+
+
+def load_assets():
+    names = sorted(os.listdir(SOURCE_DIR))
+    if PAGE not in names:
+        sys.exit("%s is missing from %s" % (PAGE, SOURCE_DIR))
+
+    contents = {}
+    for name in names:
+        if os.path.splitext(name)[1] not in CONTENT_TYPES:
+            sys.exit("no content type for %s" % name)
+        with open(os.path.join(SOURCE_DIR, name), "rb") as f:
+            contents[name] = f.read()
+
+    hashes = {name: content_hash(data) for name, data in contents.items() if name != PAGE}
+
+    def substitute(match):
+        name = match.group(1).decode()
+        if name not in hashes:
+            sys.exit("%s links %s, which is not in %s" % (PAGE, name, SOURCE_DIR))
+        return hashes[name].encode()
+
+    contents[PAGE] = HASH_PLACEHOLDER.sub(substitute, contents[PAGE])
+
+    assets = []
+    # the page first, it is what almost every request is for
+    for name in [PAGE] + [name for name in names if name != PAGE]:
+        data = contents[name]
+        assets.append({
+            "name": name,
+            "path": "/" if name == PAGE else "/" + name,
+            "content_type": CONTENT_TYPES[os.path.splitext(name)[1]],
+            "etag": content_hash(data),
+            # mtime 0 keeps the output reproducible
+            "gzip": gzip.compress(data, compresslevel=9, mtime=0),
+            "original_length": len(data),
+            "is_immutable": name != PAGE,
+        })
+    return assets
+
+
+def c_bytes(data):
+    lines = []
+    for start in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[start:start + 16]) + ",")
+    return "\n".join(lines)
+
+
+def generate(assets):
+    out = []
+    out.append("// Generated by tools/embed_assets.py from the files in www/, do not edit.")
+    out.append("")
+    out.append('#include "static_assets.h"')
+    out.append("")
+    for asset in assets:
+        name = identifier(asset["name"])
+        out.append("// %s, %d bytes, %d gzipped" % (asset["name"], asset["original_length"], len(asset["gzip"])))
+        out.append('static const char %sPath[] PROGMEM = "%s";' % (name, asset["path"]))
+        out.append('static const char %sContentType[] PROGMEM = "%s";' % (name, asset["content_type"]))
+        out.append('static const char %sETag[] PROGMEM = "\\"%s\\"";' % (name, asset["etag"]))
+        out.append("static const uint8_t %sData[] PROGMEM = {" % name)
+        out.append(c_bytes(asset["gzip"]))
+        out.append("};")
+        out.append("")
+
+    out.append("static const StaticAsset kStaticAssets[] PROGMEM = {")
+    for asset in assets:
+        name = identifier(asset["name"])
+        out.append("    { %sPath, %sContentType, %sETag, %sData, sizeof(%sData), %s }," % (
+            name, name, name, name, name, "true" if asset["is_immutable"] else "false"))
+    out.append("};")
+    out.append("")
+    out.append("const int kNumStaticAssets = sizeof(kStaticAssets) / sizeof(kStaticAssets[0]);")
+    out.append("")
+    out.append("StaticAsset staticAsset(int index) {")
+    out.append("    StaticAsset asset;")
+    out.append("    memcpy_P(&asset, &kStaticAssets[index], sizeof(asset));")
+    out.append("    return asset;")
+    out.append("}")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--check", action="store_true", help="fail if static_assets.cpp is out of date")
+    args = parser.parse_args()
+
+    assets = load_assets()
+    source = generate(assets)
+
+    for asset in assets:
+        print("%-24s %6d -> %5d bytes  %s" % (asset["path"], asset["original_length"], len(asset["gzip"]), asset["etag"]))
+
+    if args.check:
+        try:
+            with open(OUTPUT) as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != source:
+            print("static_assets.cpp is out of date, run tools/embed_assets.py", file=sys.stderr)
+            return 1
+        return 0
+
+    with open(OUTPUT, "w") as f:
+        f.write(source)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Static RAM usage per module of the irrigator sketch.
+
+Everything in .data, .rodata and .bss ends up in the 80KB of DRAM on the
+ESP8266; only what is placed in flash (PROGMEM, F()) stays out of it. This
+sums those sections for each object file of a build, e.g.
+
+    arduino-cli compile --fqbn esp8266:esp8266:nodemcuv2 --build-path build irrigator
+    tools/ram_report.py build
+
+--save records the report as a baseline, --check compares against one and
+fails if a module grew by more than --tolerance bytes, or has no figure in it.
+The baseline of the sketch is tools/ram_baseline.txt:
+
+    tools/ram_report.py build --check tools/ram_baseline.txt
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+import sys
+
+RAM_SECTION_PREFIXES = (".data", ".rodata", ".bss", "COMMON")
+
+
+def find_size_tool(explicit):
+    if explicit:
+        return explicit
+    for name in ("xtensa-lx106-elf-size", "size"):
+        path = shutil.which(name)
+        if path:
+            return path
+    sys.exit("cannot find xtensa-lx106-elf-size, pass it with --size")
+
+
+def ram_bytes(size_tool, obj):
+    output = subprocess.run([size_tool, "-A", obj], check=True, capture_output=True, text=True).stdout
+    total = 0
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(RAM_SECTION_PREFIXES) and fields[1].isdigit():
+            total += int(fields[1])
+    return total
+
+
+def module_name(obj):
+    # irrigator.ino.cpp.o -> irrigator.ino, clock.cpp.o -> clock
+    name = os.path.basename(obj)
+    for suffix in (".o", ".cpp"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+    return name
+
+
+def collect(build_path, size_tool):
+    objects = glob.glob(os.path.join(build_path, "sketch", "*.o"))
+    if not objects:
+        sys.exit("no object files under %s/sketch, is it a build path?" % build_path)
+    return {module_name(obj): ram_bytes(size_tool, obj) for obj in objects}
+
+
+def load(path):
+    report = {}
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 2 and not line.startswith("#"):
+                report[fields[0]] = int(fields[1])
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("build_path")
+    parser.add_argument("--size", help="path of xtensa-lx106-elf-size")
+    parser.add_argument("--save", metavar="FILE", help="write the report to FILE")
+    parser.add_argument("--check", metavar="FILE", help="compare against the report in FILE")
+    parser.add_argument("--tolerance", type=int, default=0, help="bytes a module may grow by")
+    args = parser.parse_args()
+
+    report = collect(args.build_path, find_size_tool(args.size))
+    baseline = load(args.check) if args.check else {}
+
+    regressions = []
+    unrecorded = []
+    for name in sorted(report, key=lambda n: -report[n]):
+        line = "%-24s %6d" % (name, report[name])
+        if name in baseline:
+            delta = report[name] - baseline[name]
+            line += "  %+d" % delta
+            if delta > args.tolerance:
+                regressions.append(name)
+        elif args.check:
+            # a module without a figure would otherwise pass unchecked
+            line += "  new"
+            unrecorded.append(name)
+        print(line)
+    print("%-24s %6d" % ("total", sum(report.values())))
+
+    if args.save:
+        with open(args.save, "w") as f:
+            f.write("# static RAM bytes per module, see tools/ram_report.py\n")
+            for name in sorted(report):
+                f.write("%s %d\n" % (name, report[name]))
+
+    if unrecorded:
+        print("no baseline for: %s, record it with --save" % ", ".join(unrecorded), file=sys.stderr)
+    if regressions:
+        print("static RAM grew in: %s" % ", ".join(regressions), file=sys.stderr)
+    return 1 if regressions or unrecorded else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())